@@ -12,68 +12,227 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
-#include "common/macros.h"
-#include "common/logger.h"
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <vector>
 
-#include <thread>
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/priority_replacer.h"
+#include "common/logger.h"
+#include "common/macros.h"
 
 namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager)
-    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager) {}
+                                                     LogManager *log_manager, ReplacerPolicy replacer_policy,
+                                                     size_t max_pool_size)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, replacer_policy, max_pool_size) {}
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                                                     DiskManager *disk_manager, LogManager *log_manager)
-    : pool_size_(pool_size),
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerPolicy replacer_policy, size_t max_pool_size)
+    : max_pool_size_(std::max(pool_size, max_pool_size)),
+      pool_size_(pool_size),
       num_instances_(num_instances),
       instance_index_(instance_index),
-      next_page_id_(instance_index),
+      numa_node_(instance_index % NumaUtil::NodeCount()),
+      free_page_map_(disk_manager, num_instances, instance_index),
       disk_manager_(disk_manager),
-      log_manager_(log_manager) {
+      log_manager_(log_manager),
+      page_table_(max_pool_size_) {
   BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
   BUSTUB_ASSERT(
       instance_index < num_instances,
       "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
-  // We allocate a consecutive memory space for the buffer pool.
-  pages_ = new Page[pool_size];
-  replacer_ = new LRUReplacer(pool_size);
+  // We allocate a consecutive memory space for the buffer pool, on the NUMA node of this instance. The page data
+  // lives in a huge page backed arena, separate from the book-keeping of the frames. Every frame the pool may grow
+  // to is reserved up front, so that frames never move while lock-free readers look at them; the memory of the
+  // frames beyond the pool size is not touched until the pool grows into them.
+  frame_arena_ = new FrameArena(max_pool_size_, numa_node_);
+  pages_ = static_cast<Page *>(NumaUtil::AllocateOnNode(max_pool_size_ * sizeof(Page), numa_node_));
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    new (&pages_[i]) Page(frame_arena_->GetFrame(i));
+  }
+  io_cv_ = new std::condition_variable[max_pool_size_];
+  // Registering the frames spares the kernel mapping them on every asynchronous request, but pins the whole arena.
+  // A pool that may grow reserves more frames than it uses, so it is left unregistered.
+  if (max_pool_size_ == pool_size) {
+    frames_registered_ = disk_manager_->RegisterBuffers(frame_arena_->GetFrame(0), max_pool_size_ * PAGE_SIZE);
+  }
+  if (compressed_page_cache_size > 0) {
+    compressed_cache_ = new CompressedPageCache(compressed_page_cache_size);
+  }
+  Replacer *policy_replacer;
+  switch (replacer_policy) {
+    case ReplacerPolicy::CLOCK:
+      policy_replacer = new ClockReplacer(max_pool_size_);
+      break;
+    case ReplacerPolicy::LRU_K:
+      policy_replacer = new LRUKReplacer(max_pool_size_);
+      break;
+    case ReplacerPolicy::LRU:
+    default:
+      policy_replacer = new LRUReplacer(max_pool_size_);
+      break;
+  }
+  replacer_ = new PriorityReplacer(policy_replacer, max_pool_size_, max_pool_size_ * HIGH_PRIORITY_PERCENT / 100);
 
-  // Initially, every page is in the free list.
-  for (size_t i = 0; i < pool_size; ++i) {
-    free_list_.emplace_back(static_cast<frame_id_t>(i));
+  // Initially, every page is in the free list. Free frames are claimed (pin count -1) so that they cannot be pinned.
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    if (i < pool_size) {
+      free_list_.emplace_back(static_cast<frame_id_t>(i));
+    }
     pages_[i].page_id_ = INVALID_PAGE_ID;
     pages_[i].is_dirty_ = false;
-    pages_[i].pin_count_ = 0;
+    pages_[i].pin_count_ = -1;
   }
+
+  cleaner_thread_ = new std::thread(&BufferPoolManagerInstance::RunPageCleaner, this);
+  prefetch_thread_ = new std::thread(&BufferPoolManagerInstance::RunPrefetcher, this);
+  disk_manager_->AddClient(this);
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
-  delete[] pages_;
+  // A disk manager shut down or destroyed before the pool has detached it already, and must not be used any more.
+  if (!detached_) {
+    disk_manager_->RemoveClient(this);
+    DetachDiskManager();
+  }
+
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    pages_[i].~Page();
+  }
+  NumaUtil::Free(pages_, max_pool_size_ * sizeof(Page));
+  delete frame_arena_;
+  delete[] io_cv_;
+  delete compressed_cache_;
   delete replacer_;
 }
 
+void BufferPoolManagerInstance::DetachDiskManager() {
+  // Unpinning does not write pages, so those dirtied since the last pass of the page cleaner would be lost.
+  FlushAllPgsImp();
+  {
+    std::scoped_lock latch(latch_);
+    shutdown_ = true;
+  }
+  cleaner_cv_.notify_one();
+  prefetch_cv_.notify_one();
+  cleaner_thread_->join();
+  prefetch_thread_->join();
+  delete cleaner_thread_;
+  delete prefetch_thread_;
+  if (frames_registered_) {
+    disk_manager_->UnregisterBuffers(frame_arena_->GetFrame(0));
+    frames_registered_ = false;
+  }
+  detached_ = true;
+}
+
 auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
   // Make sure you call DiskManager::WritePage!
-  std::unique_lock<std::mutex> latch(latch_);
-  auto it = page_table_.find(page_id);
-  if (it == page_table_.cend()) {
-    return false;
+  auto latch = AcquireLatch();
+  while (true) {
+    frame_id_t frame_id;
+    if (!page_table_.Find(page_id, &frame_id)) {
+      return false;
+    }
+    Page *page = &pages_[frame_id];
+    if (page->io_in_progress_) {
+      // The frame may hold another page once the I/O completes, so look it up again.
+      WaitForIo(&latch, frame_id);
+      continue;
+    }
+    if (!page->IsDirty()) {
+      return true;
+    }
+    // Clear the dirty flag before writing so that an unpin marking the page dirty during the write is not lost.
+    page->is_dirty_ = false;
+    page->io_in_progress_ = true;
+    latch.unlock();
+    disk_manager_->GetIoScheduler()->Run(IoClass::DEMAND, 1,
+                                         [&] { disk_manager_->WritePage(page_id, page->GetData()); });
+    ReacquireLatch(&latch);
+    stats_.Add(BufferPoolCounter::WRITE_BACKS);
+    FinishIo(frame_id);
+    return true;
   }
-  auto frame_id = it->second;
-  if(pages_[frame_id].IsDirty()) {
-    disk_manager_->WritePage(page_id,pages_[frame_id].GetData());
+}
+
+void BufferPoolManagerInstance::FlushAllPgsImp() {
+  std::vector<DirtyPage> dirty_pages;
+  std::vector<page_id_t> busy_pages;
+  BeginFlush(&dirty_pages, &busy_pages);
+  std::sort(dirty_pages.begin(), dirty_pages.end());
+  EndFlush(dirty_pages, WriteSortedPages(disk_manager_, dirty_pages.data(), dirty_pages.size()));
+  for (auto page_id : busy_pages) {
+    FlushPgImp(page_id);
   }
-  pages_[frame_id].is_dirty_ = false;
+  FlushFreePageMap();
+  disk_manager_->Sync();
+}
 
-  return true;
+void BufferPoolManagerInstance::BeginFlush(std::vector<DirtyPage> *dirty_pages, std::vector<page_id_t> *busy_pages) {
+  auto latch = AcquireLatch();
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    Page *page = &pages_[i];
+    if (page->page_id_ == INVALID_PAGE_ID || !page->is_dirty_) {
+      continue;
+    }
+    if (page->io_in_progress_) {
+      // Modified again while being written back. Waiting for that write here could deadlock with a concurrent flush
+      // holding frames of other instances, so leave it to the caller.
+      busy_pages->push_back(page->page_id_);
+      continue;
+    }
+    // Clear the dirty flag before writing so that an unpin marking the page dirty during the write is not lost.
+    page->is_dirty_ = false;
+    page->io_in_progress_ = true;
+    dirty_pages->emplace_back(page->page_id_, page->GetData());
+  }
 }
 
-void BufferPoolManagerInstance::FlushAllPgsImp() {
-  // You can do it!
-  for(auto &page : page_table_) {
-    FlushPgImp(page.first);
+void BufferPoolManagerInstance::EndFlush(const std::vector<DirtyPage> &dirty_pages,
+                                         const std::vector<page_id_t> &failed_pages) {
+  auto latch = AcquireLatch();
+  size_t written = 0;
+  for (const auto &[page_id, data] : dirty_pages) {
+    // The frames are mapped as long as they are being written, so the page table still finds them.
+    frame_id_t frame_id;
+    if (page_id % num_instances_ == instance_index_ && page_table_.Find(page_id, &frame_id)) {
+      if (std::binary_search(failed_pages.begin(), failed_pages.end(), page_id)) {
+        // Keep the change for a later write rather than losing it with the failed one.
+        pages_[frame_id].is_dirty_ = true;
+      } else {
+        written++;
+      }
+      FinishIo(frame_id);
+    }
+  }
+  stats_.Add(BufferPoolCounter::WRITE_BACKS, written);
+}
+
+auto BufferPoolManagerInstance::WriteSortedPages(DiskManager *disk_manager, const DirtyPage *dirty_pages,
+                                                 size_t num_pages) -> std::vector<page_id_t> {
+  std::vector<page_id_t> failed_pages;
+  const char *run[FLUSH_MAX_RUN];
+  for (size_t begin = 0; begin < num_pages;) {
+    size_t length = 0;
+    while (begin + length < num_pages && length < FLUSH_MAX_RUN &&
+           dirty_pages[begin + length].first == dirty_pages[begin].first + static_cast<page_id_t>(length)) {
+      run[length] = dirty_pages[begin + length].second;
+      length++;
+    }
+    if (!disk_manager->WritePages(dirty_pages[begin].first, run, length)) {
+      for (size_t i = 0; i < length; ++i) {
+        failed_pages.push_back(dirty_pages[begin + i].first);
+      }
+    }
+    begin += length;
   }
+  return failed_pages;
 }
 
 auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
@@ -82,37 +241,52 @@ auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
-  std::unique_lock<std::mutex> latch(latch_);
-  
+  auto latch = AcquireLatch();
   frame_id_t frame_id;
-  Page *page;
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-    page = pages_ + frame_id;
-  }else if (replacer_->Victim(&frame_id)) {
-    page = pages_ + frame_id;
-    if(pages_[frame_id].IsDirty()) {
-      disk_manager_->WritePage(page->GetPageId(),page->GetData());
-    }
-    page_table_.erase(page->GetPageId());
-    page->is_dirty_ = false;
-  }else {
+  if (!AcquireFrame(&latch, &frame_id)) {
     return nullptr;
   }
 
-  auto new_page_id = AllocatePage();
- 
+  Page *page = &pages_[frame_id];
+  bool reused;
+  page_id_t new_page_id = AllocatePage(&reused);
   page->page_id_ = new_page_id;
-  page->pin_count_++;
+  // A reused page is written back even if it stays empty, or it would read back with its old content.
+  page->is_dirty_ = reused;
+  page->read_ahead_ = false;
   page->ResetMemory();
-  page_table_[new_page_id] = frame_id;
+  page_table_.Insert(new_page_id, frame_id);
+  replacer_->Pin(frame_id);
+  page->pin_count_ = 1;
+  CountPinnedFrame();
+  latch.unlock();
 
+  // The page is pinned, so it cannot be written before the map is.
+  free_page_map_.WriteAllocations();
   *page_id = new_page_id;
   return page;
 }
 
-auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
+auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id, PagePriority priority) -> Page * {
+  Page *page = NewPgImp(page_id);
+  // The page is pinned, so the replacer learns its priority before the frame can enter it.
+  if (page != nullptr && priority != PagePriority::NORMAL) {
+    replacer_->SetPriority(static_cast<frame_id_t>(page - pages_), priority);
+  }
+  return page;
+}
+
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * { return FetchPgImp(page_id, nullptr); }
+
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id, PagePriority priority) -> Page * {
+  Page *page = FetchPgImp(page_id, nullptr);
+  if (page != nullptr && priority != PagePriority::NORMAL) {
+    replacer_->SetPriority(static_cast<frame_id_t>(page - pages_), priority);
+  }
+  return page;
+}
+
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
@@ -120,97 +294,873 @@ auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  std::unique_lock<std::mutex> latch(latch_);
-  
   frame_id_t frame_id;
-  auto it = page_table_.find(page_id);
-  if(it != page_table_.end()) {
-    frame_id = it->second;
-    replacer_->Pin(frame_id);
-    pages_[frame_id].pin_count_++;
-    pages_[frame_id].is_dirty_ = true;
+  if (page_table_.Find(page_id, &frame_id) && TryPin(frame_id, page_id)) {
+    stats_.Add(BufferPoolCounter::HITS);
     return &pages_[frame_id];
   }
-  
-  Page *page;
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-    page = pages_ + frame_id;
-  }else if (replacer_->Victim(&frame_id)) {
-    page = pages_ + frame_id;
-    if(pages_[frame_id].IsDirty()) {
-      disk_manager_->WritePage(page->GetPageId(),page->GetData());
-    }
-    page_table_.erase(page->GetPageId());
+
+  auto latch = AcquireLatch();
+  while (true) {
+    if (page_table_.Find(page_id, &frame_id)) {
+      Page *page = &pages_[frame_id];
+      if (page->pin_count_ < 0) {
+        // Under the latch a mapped frame is only unpinnable while its eviction writes it back.
+        WaitForIo(&latch, frame_id);
+        continue;
+      }
+      // Pin before waiting so that the frame cannot be evicted while another thread is still reading it in.
+      if (page->pin_count_++ == 0) {
+        CountPinnedFrame();
+        replacer_->Pin(frame_id);
+      }
+      if (page->read_ahead_) {
+        page->read_ahead_ = false;
+        if (strategy != nullptr) {
+          // A bulk reader adopts a page that was read ahead for it into its ring, handing back the oldest ring frame
+          // in exchange, so that read-ahead does not let the scan grow past its ring.
+          frame_id_t spare;
+          if (RecycleRingFrame(strategy, page_id, &spare)) {
+            strategy->Renew(strategy->GetRingSize() - 1, frame_id, page_id);
+            ReturnFreeFrame(spare);
+          } else {
+            strategy->Advance(this, frame_id, page_id);
+          }
+        }
+      }
+      WaitForIo(&latch, frame_id);
+      stats_.Add(BufferPoolCounter::HITS);
+      return page;
+    }
+
+    auto miss_start = std::chrono::steady_clock::now();
+    bool recycled = strategy != nullptr && RecycleRingFrame(strategy, page_id, &frame_id);
+    if (!recycled && !AcquireFrame(&latch, &frame_id)) {
+      return nullptr;
+    }
+    frame_id_t existing;
+    if (page_table_.Find(page_id, &existing)) {
+      // Another thread brought the page in while the latch was released to write back our victim.
+      ReturnFreeFrame(frame_id);
+      continue;
+    }
+
+    Page *page = &pages_[frame_id];
+    page->page_id_ = page_id;
     page->is_dirty_ = false;
-  }else {
-    return nullptr;
+    page->io_in_progress_ = true;
+    page->read_ahead_ = false;
+    page_table_.Insert(page_id, frame_id);
+    replacer_->Pin(frame_id);
+    page->pin_count_ = 1;
+    CountPinnedFrame();
+    if (strategy != nullptr && !recycled) {
+      strategy->Advance(this, frame_id, page_id);
+    }
+
+    latch.unlock();
+    ReadPageData(page_id, page->GetData(), IoClass::DEMAND);
+    ReacquireLatch(&latch);
+    FinishIo(frame_id);
+    stats_.Add(BufferPoolCounter::MISSES);
+    stats_.RecordMissLatency(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - miss_start).count());
+    return page;
   }
+}
 
-  page_table_[page_id] = frame_id;
-  replacer_->Pin(frame_id);
+auto BufferPoolManagerInstance::FetchPgsImp(const page_id_t *page_ids, size_t num_pages, Page **pages) -> bool {
+  auto start = std::chrono::steady_clock::now();
+  auto latch = AcquireLatch();
+  std::vector<frame_id_t> reads;
+  bool fetched_all = true;
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id = page_ids[i];
+    pages[i] = nullptr;
+    while (true) {
+      frame_id_t frame_id;
+      if (page_table_.Find(page_id, &frame_id)) {
+        Page *page = &pages_[frame_id];
+        if (page->pin_count_ < 0) {
+          WaitForIo(&latch, frame_id);
+          continue;
+        }
+        // The page may still be read in by another thread, or by this batch; that is waited for at the end.
+        if (page->pin_count_++ == 0) {
+          CountPinnedFrame();
+          replacer_->Pin(frame_id);
+        }
+        page->read_ahead_ = false;
+        stats_.Add(BufferPoolCounter::HITS);
+        pages[i] = page;
+        break;
+      }
+
+      if (!AcquireFrame(&latch, &frame_id)) {
+        break;
+      }
+      frame_id_t existing;
+      if (page_table_.Find(page_id, &existing)) {
+        ReturnFreeFrame(frame_id);
+        continue;
+      }
+      Page *page = &pages_[frame_id];
+      page->page_id_ = page_id;
+      page->is_dirty_ = false;
+      page->io_in_progress_ = true;
+      page->read_ahead_ = false;
+      page_table_.Insert(page_id, frame_id);
+      replacer_->Pin(frame_id);
+      page->pin_count_ = 1;
+      CountPinnedFrame();
+      reads.push_back(frame_id);
+      pages[i] = page;
+      break;
+    }
+    fetched_all = fetched_all && pages[i] != nullptr;
+  }
+
+  if (!reads.empty()) {
+    std::sort(reads.begin(), reads.end(),
+              [this](frame_id_t a, frame_id_t b) { return pages_[a].page_id_ < pages_[b].page_id_; });
+    latch.unlock();
+    ReadSortedPages(reads);
+    ReacquireLatch(&latch);
+    for (auto frame_id : reads) {
+      FinishIo(frame_id);
+    }
+    // Every miss of the batch is served once the whole batch is read.
+    auto latency_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    stats_.Add(BufferPoolCounter::MISSES, reads.size());
+    for (size_t i = 0; i < reads.size(); ++i) {
+      stats_.RecordMissLatency(latency_us);
+    }
+  }
+  for (size_t i = 0; i < num_pages; ++i) {
+    if (pages[i] != nullptr) {
+      WaitForIo(&latch, static_cast<frame_id_t>(pages[i] - pages_));
+    }
+  }
+  return fetched_all;
+}
 
-  pages_[frame_id].page_id_ = page_id;
-  pages_[frame_id].pin_count_++;
-  pages_[frame_id].is_dirty_ = false;
-  disk_manager_->ReadPage(page_id, pages_[frame_id].GetData());
-  
+auto BufferPoolManagerInstance::FetchPgOptimisticImp(page_id_t page_id, uint64_t *version) -> Page * {
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    return nullptr;
+  }
+  Page *page = &pages_[frame_id];
+  *version = page->ReadVersion();
+  // Evicting the frame bumps the version after the page id changes, so a read that saw this page id and this
+  // version is validated against the right page.
+  if ((*version & 1) != 0 || page->page_id_ != page_id || page->io_in_progress_) {
+    return nullptr;
+  }
+  // The read takes no pin, but it is still a use of the page, so that hot pages that are only read optimistically
+  // do not become victims. Without the latch the frame may be claimed or pinned, so only mark it for the replacer.
+  if (!page->referenced_) {
+    page->referenced_ = true;
+  }
   return page;
 }
 
+auto BufferPoolManagerInstance::FetchResidentPgImp(page_id_t page_id) -> Page * {
+  auto latch = AcquireLatch();
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id) || pages_[frame_id].io_in_progress_) {
+    return nullptr;
+  }
+  Page *page = &pages_[frame_id];
+  stats_.Add(BufferPoolCounter::HITS);
+  if (page->pin_count_++ == 0) {
+    CountPinnedFrame();
+    if (page->read_ahead_) {
+      // Peeking at a page that was read ahead is not a use of it, so do not let the replacer count it as one.
+      replacer_->Remove(frame_id);
+    } else {
+      replacer_->Pin(frame_id);
+    }
+  }
+  return page;
+}
+
+void BufferPoolManagerInstance::PrefetchPgImp(page_id_t page_id) {
+  ValidatePageId(page_id);
+  frame_id_t frame_id;
+  if (page_table_.Find(page_id, &frame_id)) {
+    return;
+  }
+  {
+    auto latch = AcquireLatch();
+    if (page_table_.Find(page_id, &frame_id) || prefetch_queue_.size() >= PREFETCH_QUEUE_SIZE) {
+      return;
+    }
+    prefetch_queue_.push_back(page_id);
+  }
+  prefetch_cv_.notify_one();
+}
+
 auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
   // 0.   Make sure you call DeallocatePage!
   // 1.   Search the page table for the requested page (P).
   // 1.   If P does not exist, return true.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-  std::unique_lock<std::mutex> latch(latch_);
-  DeallocatePage(page_id);
+  auto latch = AcquireLatch();
+  while (true) {
+    frame_id_t frame_id;
+    if (!page_table_.Find(page_id, &frame_id)) {
+      if (compressed_cache_ != nullptr) {
+        compressed_cache_->Erase(page_id);
+      }
+      DeallocatePage(page_id);
+      return true;
+    }
+    Page *page = &pages_[frame_id];
+    if (page->io_in_progress_) {
+      WaitForIo(&latch, frame_id);
+      continue;
+    }
+    if (!TryClaimFrame(frame_id)) {
+      return false;
+    }
 
-  auto it = page_table_.find(page_id);
-  if(it == page_table_.end())  
+    DeallocatePage(page_id);
+    page_table_.Erase(page_id);
+    replacer_->Remove(frame_id);
+    page->page_id_ = INVALID_PAGE_ID;
+    page->is_dirty_ = false;
+    page->BumpVersion();
+    page->ResetMemory();
+    ReturnFreeFrame(frame_id);
     return true;
- 
-  auto frame_id = it->second;
-  if(pages_[frame_id].GetPinCount() > 0) 
-    return false;
+  }
+}
 
-  page_table_.erase(page_id);
-  pages_[frame_id].page_id_ = INVALID_PAGE_ID;
-  pages_[frame_id].is_dirty_ = false;
-  pages_[frame_id].ResetMemory();
+auto BufferPoolManagerInstance::ResizeImp(size_t pool_size) -> bool {
+  if (pool_size == 0 || pool_size > max_pool_size_) {
+    return false;
+  }
+  std::scoped_lock resize_latch(resize_latch_);
+  std::unique_lock<std::mutex> latch(latch_);
+  size_t old_pool_size = pool_size_;
+  pool_size_ = pool_size;
+  if (pool_size >= old_pool_size) {
+    for (size_t i = old_pool_size; i < pool_size; ++i) {
+      ReturnFreeFrame(static_cast<frame_id_t>(i));
+    }
+    return true;
+  }
 
-  free_list_.push_back(frame_id);
+  // From here on no frame beyond the new size is handed out. Take them off the free list and evict their pages.
+  free_list_.remove_if([&](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= pool_size; });
+  // Announced before any pin count is looked at, so that an unpin after the look is sure to wake us up.
+  resize_waiting_ = true;
+  auto unpin_deadline = std::chrono::steady_clock::time_point::max();
+  bool written_back = false;
+  for (size_t i = pool_size; i < old_pool_size;) {
+    auto frame_id = static_cast<frame_id_t>(i);
+    Page *page = &pages_[frame_id];
+    if (page->io_in_progress_) {
+      // The frame may hold another page once the I/O completes, or, if the read-ahead worker holds it unmapped, the
+      // page it reads ahead. Look at it again.
+      WaitForIo(&latch, frame_id);
+      continue;
+    }
+    if (page->page_id_ == INVALID_PAGE_ID) {
+      written_back = false;
+      unpin_deadline = std::chrono::steady_clock::time_point::max();
+      ++i;
+      continue;
+    }
+    if (page->IsDirty()) {
+      // Write the page back as background I/O before claiming the frame, and only mark it busy once the write is
+      // admitted, so that fetches of the page do not wait behind the background budget. Then look at it again.
+      latch.unlock();
+      disk_manager_->GetIoScheduler()->Run(IoClass::WRITE_BACK, 1, [&] {
+        latch.lock();
+        if (page->page_id_ == INVALID_PAGE_ID || !page->IsDirty() || page->io_in_progress_) {
+          latch.unlock();
+          return;
+        }
+        page->is_dirty_ = false;
+        page->io_in_progress_ = true;
+        latch.unlock();
+        disk_manager_->WritePage(page->GetPageId(), page->GetData());
+        latch.lock();
+        FinishIo(frame_id);
+        stats_.Add(BufferPoolCounter::WRITE_BACKS);
+        written_back = true;
+        latch.unlock();
+      });
+      latch.lock();
+      continue;
+    }
+    if (!TryClaimFrame(frame_id)) {
+      // Wait for the last unpin of the page, but not for a page that is never released, like that of a scan left
+      // open. Giving up takes the pool back to its old size.
+      if (unpin_deadline == std::chrono::steady_clock::time_point::max()) {
+        unpin_deadline = std::chrono::steady_clock::now() + resize_timeout;
+      }
+      if (unpin_cv_.wait_until(latch, unpin_deadline) == std::cv_status::timeout && page->pin_count_ > 0) {
+        resize_waiting_ = false;
+        pool_size_ = old_pool_size;
+        for (size_t j = pool_size; j < old_pool_size; ++j) {
+          if (pages_[j].page_id_ == INVALID_PAGE_ID && !pages_[j].io_in_progress_) {
+            ReturnFreeFrame(static_cast<frame_id_t>(j));
+          }
+        }
+        return false;
+      }
+      continue;
+    }
 
+    if (page->IsDirty()) {
+      // Dirtied again between the write and the claim.
+      page->pin_count_ = 0;
+      continue;
+    }
+    replacer_->Remove(frame_id);
+    stats_.Add(written_back ? BufferPoolCounter::DIRTY_EVICTIONS : BufferPoolCounter::CLEAN_EVICTIONS);
+    page_table_.Erase(page->GetPageId());
+    page->page_id_ = INVALID_PAGE_ID;
+    page->BumpVersion();
+    written_back = false;
+    unpin_deadline = std::chrono::steady_clock::time_point::max();
+    ++i;
+  }
+  resize_waiting_ = false;
+  // Registered frames are pinned, and releasing them would detach the mapping from the memory the kernel reads into.
+  if (!frames_registered_) {
+    frame_arena_->Release(pool_size, old_pool_size - pool_size);
+  }
   return true;
 }
 
-auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool { 
-  std::unique_lock<std::mutex> latch(latch_);
+void BufferPoolManagerInstance::GetResidentPgsImp(std::vector<page_id_t> *page_ids) {
+  std::scoped_lock latch(latch_);
+  std::vector<bool> ranked(max_pool_size_, false);
+  auto add = [&](frame_id_t frame_id) {
+    Page *page = &pages_[frame_id];
+    if (!ranked[frame_id] && page->page_id_ != INVALID_PAGE_ID && !page->io_in_progress_) {
+      ranked[frame_id] = true;
+      page_ids->push_back(page->page_id_);
+    }
+  };
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    if (pages_[i].pin_count_ > 0) {
+      add(static_cast<frame_id_t>(i));
+    }
+  }
+  auto order = replacer_->EvictionOrder();
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    add(*it);
+  }
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    add(static_cast<frame_id_t>(i));
+  }
+}
 
-  auto it = page_table_.find(page_id);
-  if(it == page_table_.end())  
-    return true;
-  auto frame_id = it->second;
+void BufferPoolManagerInstance::GetStatsImp(BufferPoolStats *stats) {
+  stats_.Collect(stats);
+  stats->pinned_high_water_ += pinned_high_water_;
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->Collect(stats);
+  }
+  std::scoped_lock latch(latch_);
+  stats->free_frames_ += free_list_.size();
+}
+
+auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  // The caller holds a pin, so the frame of the page cannot change; only a lock-free miss needs the latch.
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id) || pages_[frame_id].page_id_ != page_id) {
+    auto latch = AcquireLatch();
+    if (!page_table_.Find(page_id, &frame_id)) {
+      return true;
+    }
+  }
+  return ReleasePin(frame_id, is_dirty);
+}
 
-  if(pages_[frame_id].pin_count_ == 0) 
+auto BufferPoolManagerInstance::UnpinPgsImp(const page_id_t *page_ids, size_t num_pages, bool is_dirty) -> bool {
+  bool unpinned_all = true;
+  for (size_t i = 0; i < num_pages; ++i) {
+    unpinned_all = UnpinPgImp(page_ids[i], is_dirty) && unpinned_all;
+  }
+  return unpinned_all;
+}
+
+auto BufferPoolManagerInstance::TryPin(frame_id_t frame_id, page_id_t page_id) -> bool {
+  Page *page = &pages_[frame_id];
+  int pin_count = page->pin_count_;
+  do {
+    if (pin_count < 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+  if (pin_count == 0) {
+    CountPinnedFrame();
+  }
+
+  // The pin keeps the frame from being evicted from now on, but it may have been reused before we got it. Pages
+  // being read in, and pages read ahead that a bulk reader may want to adopt, take the latched path.
+  if (page->page_id_ != page_id || page->io_in_progress_ || page->read_ahead_) {
+    ReleasePin(frame_id, false);
     return false;
-  pages_[frame_id].is_dirty_ = is_dirty;
+  }
+  if (pin_count == 0) {
+    replacer_->Pin(frame_id);
+  }
+  return true;
+}
 
-  if(--pages_[frame_id].pin_count_ == 0) {
+auto BufferPoolManagerInstance::ReleasePin(frame_id_t frame_id, bool is_dirty) -> bool {
+  Page *page = &pages_[frame_id];
+  int pin_count = page->pin_count_;
+  if (pin_count <= 0) {
+    return false;
+  }
+  // The write-back of dirty pages is left to the page cleaner or to eviction.
+  if (is_dirty) {
+    page->is_dirty_ = true;
+  }
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+  if (pin_count == 1) {
+    pinned_frames_--;
     replacer_->Unpin(frame_id);
-    if (pages_[frame_id].IsDirty()) {
-      disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
+    if (resize_waiting_) {
+      // Taking the latch orders the wake-up after the resize started waiting. Nobody unpins while holding it.
+      std::scoped_lock latch(latch_);
+      unpin_cv_.notify_all();
+    }
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::CountPinnedFrame() {
+  size_t pinned = ++pinned_frames_;
+  size_t high_water = pinned_high_water_.load(std::memory_order_relaxed);
+  while (pinned > high_water && !pinned_high_water_.compare_exchange_weak(high_water, pinned)) {
+  }
+}
+
+auto BufferPoolManagerInstance::AcquireLatch() -> std::unique_lock<std::mutex> {
+  std::unique_lock<std::mutex> lock(latch_, std::defer_lock);
+  ReacquireLatch(&lock);
+  return lock;
+}
+
+void BufferPoolManagerInstance::ReacquireLatch(std::unique_lock<std::mutex> *lock) {
+  if (lock->try_lock()) {
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+  lock->lock();
+  stats_.Add(BufferPoolCounter::LATCH_WAIT_NS,
+             std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+auto BufferPoolManagerInstance::TryClaimFrame(frame_id_t frame_id) -> bool {
+  int unpinned = 0;
+  return pages_[frame_id].pin_count_.compare_exchange_strong(unpinned, -1);
+}
+
+auto BufferPoolManagerInstance::GiveSecondChance(frame_id_t frame_id) -> bool {
+  Page *page = &pages_[frame_id];
+  if (!page->referenced_.exchange(false)) {
+    return false;
+  }
+  // Record the use while the frame is still claimed, then release the claim and make it evictable again.
+  replacer_->Pin(frame_id);
+  page->pin_count_ = 0;
+  replacer_->Unpin(frame_id);
+  return true;
+}
+
+void BufferPoolManagerInstance::ReturnFreeFrame(frame_id_t frame_id) {
+  if (static_cast<size_t>(frame_id) < pool_size_) {
+    free_list_.push_back(frame_id);
+  }
+}
+
+auto BufferPoolManagerInstance::AcquireFrame(std::unique_lock<std::mutex> *lock, frame_id_t *frame_id) -> bool {
+  size_t second_chances = 0;
+  while (true) {
+    if (!free_list_.empty()) {
+      *frame_id = free_list_.front();
+      free_list_.pop_front();
+      if (free_list_.size() < FreeFrameTarget()) {
+        cleaner_cv_.notify_one();
+      }
+      return true;
+    }
+    cleaner_cv_.notify_one();
+
+    frame_id_t victim;
+    if (!replacer_->Victim(&victim)) {
+      return false;
+    }
+    // Pins are taken without the latch, so the replacer may hand out a frame that was pinned in the meantime, or
+    // that is already free. Such a frame goes back to the replacer once its last pin is dropped. Frames given up by a
+    // shrinking of the pool are evicted by the resize itself.
+    if (static_cast<size_t>(victim) >= pool_size_ || !TryClaimFrame(victim)) {
+      continue;
+    }
+    Page *page = &pages_[victim];
+    if (page->io_in_progress_) {
+      // The victim is being flushed. Give it back and look at it again once the flush completes.
+      page->pin_count_ = 0;
+      WaitForIo(lock, victim);
+      if (page->pin_count_ == 0) {
+        replacer_->Unpin(victim);
+      }
+      continue;
+    }
+    if (second_chances < pool_size_ && GiveSecondChance(victim)) {
+      ++second_chances;
+      continue;
+    }
+
+    bool dirty = page->IsDirty();
+    if (dirty || compressed_cache_ != nullptr) {
+      // Write the victim back and keep a compressed copy of it with the latch released. Nobody can pin the frame
+      // while it is claimed; a concurrent fetch of the page waits for us and then reads the page back from the
+      // compressed page cache or the disk.
+      page->is_dirty_ = false;
+      page->io_in_progress_ = true;
+      lock->unlock();
+      if (dirty) {
+        disk_manager_->GetIoScheduler()->Run(
+            IoClass::DEMAND, 1, [&] { disk_manager_->WritePage(page->GetPageId(), page->GetData()); });
+      }
+      if (compressed_cache_ != nullptr) {
+        compressed_cache_->Insert(page->GetPageId(), page->GetData());
+      }
+      ReacquireLatch(lock);
+      FinishIo(victim);
+    }
+    if (dirty) {
+      stats_.Add(BufferPoolCounter::DIRTY_EVICTIONS);
+      stats_.Add(BufferPoolCounter::WRITE_BACKS);
+    } else {
+      stats_.Add(BufferPoolCounter::CLEAN_EVICTIONS);
+    }
+
+    page_table_.Erase(page->GetPageId());
+    page->page_id_ = INVALID_PAGE_ID;
+    page->BumpVersion();
+    *frame_id = victim;
+    return true;
+  }
+}
+
+auto BufferPoolManagerInstance::RecycleRingFrame(BufferAccessStrategy *strategy, page_id_t page_id,
+                                                 frame_id_t *frame_id) -> bool {
+  // With several instances the ring interleaves frames of all of them, so look for the oldest one of ours.
+  for (size_t i = 0; i < strategy->GetRingSize(); ++i) {
+    auto &slot = strategy->SlotAt(i);
+    if (slot.owner_ != this) {
+      continue;
+    }
+    Page *page = &pages_[slot.frame_id_];
+    // Dirty ring frames are left to the page cleaner rather than written back on the scan's critical path.
+    if (static_cast<size_t>(slot.frame_id_) >= pool_size_ || page->page_id_ != slot.page_id_ || page->is_dirty_ ||
+        page->io_in_progress_ || !TryClaimFrame(slot.frame_id_)) {
+      continue;
+    }
+    replacer_->Remove(slot.frame_id_);
+    page_table_.Erase(page->page_id_);
+    page->page_id_ = INVALID_PAGE_ID;
+    page->BumpVersion();
+    stats_.Add(BufferPoolCounter::CLEAN_EVICTIONS);
+    *frame_id = slot.frame_id_;
+    strategy->Renew(i, slot.frame_id_, page_id);
+    return true;
+  }
+  return false;
+}
+
+void BufferPoolManagerInstance::RunPageCleaner() {
+  std::unique_lock<std::mutex> latch(latch_);
+  while (!shutdown_) {
+    cleaner_cv_.wait_for(latch, page_cleaner_interval);
+    if (shutdown_) {
+      break;
+    }
+    CleanDirtyFrames(&latch);
+    RefillFreeList(&latch);
+  }
+}
+
+void BufferPoolManagerInstance::RunPrefetcher() {
+  std::unique_lock<std::mutex> latch(latch_);
+  while (true) {
+    prefetch_cv_.wait(latch, [&] { return shutdown_ || !prefetch_queue_.empty(); });
+    if (shutdown_) {
+      break;
+    }
+    page_id_t page_id = prefetch_queue_.front();
+    prefetch_queue_.pop_front();
+    frame_id_t frame_id;
+    if (page_table_.Find(page_id, &frame_id)) {
+      continue;
+    }
+
+    if (!AcquireFrame(&latch, &frame_id)) {
+      // Every frame is pinned; read-ahead is only a hint, so drop the request.
+      continue;
+    }
+    frame_id_t existing;
+    if (page_table_.Find(page_id, &existing)) {
+      ReturnFreeFrame(frame_id);
+      continue;
+    }
+
+    // The page is only mapped once the read is admitted. A fetch of it meanwhile reads the page itself instead of
+    // waiting for a read-ahead held back by the share or the rate limit of background I/O. The frame is marked busy
+    // until then, so that a shrinking of the pool waits for it instead of giving it up under us.
+    Page *page = &pages_[frame_id];
+    page->io_in_progress_ = true;
+    bool mapped = false;
+    auto map_page = [&] {
+      latch.lock();
+      if (page_table_.Find(page_id, &existing)) {
+        latch.unlock();
+        return;
+      }
+      // The frame is not in the replacer while it is read, so it cannot be evicted under us.
+      page->page_id_ = page_id;
+      page->is_dirty_ = false;
+      page->read_ahead_ = true;
+      page_table_.Insert(page_id, frame_id);
+      replacer_->Remove(frame_id);
+      page->pin_count_ = 0;
+      mapped = true;
+      latch.unlock();
+    };
+    latch.unlock();
+    if (compressed_cache_ != nullptr && compressed_cache_->Lookup(page_id, page->GetData())) {
+      map_page();
+    } else {
+      disk_manager_->GetIoScheduler()->Run(IoClass::PREFETCH, 1, [&] {
+        map_page();
+        if (mapped) {
+          disk_manager_->ReadPage(page_id, page->GetData());
+        }
+      });
+    }
+    latch.lock();
+    FinishIo(frame_id);
+    if (!mapped) {
+      ReturnFreeFrame(frame_id);
+      continue;
+    }
+    if (page->pin_count_ == 0) {
+      replacer_->Unpin(frame_id);
+    }
+  }
+}
+
+void BufferPoolManagerInstance::CleanDirtyFrames(std::unique_lock<std::mutex> *lock) {
+  bool wal_enabled = enable_logging && log_manager_ != nullptr;
+  auto is_candidate = [&](Page *page) {
+    // WAL: a page may only reach the disk once the log records describing its changes are persistent.
+    return page->page_id_ != INVALID_PAGE_ID && page->is_dirty_ && page->pin_count_ == 0 && !page->io_in_progress_ &&
+           (!wal_enabled || page->GetLSN() <= log_manager_->GetPersistentLSN());
+  };
+  size_t num_candidates = 0;
+  for (size_t i = 0; i < max_pool_size_ && num_candidates < PAGE_CLEANER_BATCH_SIZE; ++i) {
+    num_candidates += is_candidate(&pages_[i]) ? 1 : 0;
+  }
+  if (num_candidates == 0) {
+    return;
+  }
+
+  // The frames are only marked busy once the batch is admitted. Fetches of them meanwhile proceed instead of waiting
+  // for a write-back held back by the share or the rate limit of background I/O.
+  std::vector<frame_id_t> batch;
+  std::mutex written_latch;
+  std::condition_variable written_cv;
+  size_t pending = 0;
+  std::vector<page_id_t> failed_pages;
+  auto written = [&](page_id_t page_id, bool done) {
+    std::scoped_lock latch(written_latch);
+    if (!done) {
+      failed_pages.push_back(page_id);
+    }
+    if (--pending == 0) {
+      written_cv.notify_one();
+    }
+  };
+  lock->unlock();
+  disk_manager_->GetIoScheduler()->Run(IoClass::WRITE_BACK, num_candidates, [&] {
+    lock->lock();
+    for (size_t i = 0; i < max_pool_size_ && batch.size() < num_candidates; ++i) {
+      Page *page = &pages_[i];
+      if (!is_candidate(page)) {
+        continue;
+      }
+      // Announce the write before checking the pin count again: a lock-free fetch pins first and checks for I/O
+      // afterwards, so either it sees the write and waits for it, or we see its pin and leave the page alone.
+      page->io_in_progress_ = true;
+      if (page->pin_count_ != 0) {
+        FinishIo(static_cast<frame_id_t>(i));
+        continue;
+      }
+      page->is_dirty_ = false;
+      batch.push_back(static_cast<frame_id_t>(i));
+    }
+
+    std::sort(batch.begin(), batch.end(),
+              [this](frame_id_t a, frame_id_t b) { return pages_[a].page_id_ < pages_[b].page_id_; });
+    // Runs of consecutive pages go out as one vectored write each. The other pages are kept in flight at once
+    // through the asynchronous path while the runs are written, and the whole batch is waited for.
+    std::vector<DirtyPage> runs;
+    std::vector<DiskManager::DiskRequest> requests;
+    for (size_t begin = 0, end; begin < batch.size(); begin = end) {
+      for (end = begin + 1; end < batch.size() && pages_[batch[end]].page_id_ == pages_[batch[end - 1]].page_id_ + 1;
+           ++end) {
+      }
+      for (size_t i = begin; i < end; ++i) {
+        Page *page = &pages_[batch[i]];
+        page_id_t page_id = page->page_id_;
+        if (end - begin > 1) {
+          runs.emplace_back(page_id, page->GetData());
+        } else {
+          auto callback = [&written, page_id](bool done) { written(page_id, done); };
+          requests.push_back({true, page_id, page->GetData(), callback});
+        }
+      }
+    }
+    pending = requests.size();
+    lock->unlock();
+
+    if (!requests.empty()) {
+      disk_manager_->SubmitRequests(requests.data(), requests.size());
+    }
+    std::vector<page_id_t> failed_runs = WriteSortedPages(disk_manager_, runs.data(), runs.size());
+    std::unique_lock<std::mutex> latch(written_latch);
+    written_cv.wait(latch, [&] { return pending == 0; });
+    failed_pages.insert(failed_pages.end(), failed_runs.begin(), failed_runs.end());
+  });
+  lock->lock();
+  size_t written_back = 0;
+  for (auto frame_id : batch) {
+    Page *page = &pages_[frame_id];
+    if (std::find(failed_pages.begin(), failed_pages.end(), page->page_id_) != failed_pages.end()) {
+      // The dirty flag was cleared when the write started; set it again so that the change is not lost.
+      page->is_dirty_ = true;
+    } else {
+      written_back++;
+    }
+    FinishIo(frame_id);
+  }
+  stats_.Add(BufferPoolCounter::WRITE_BACKS, written_back);
+}
+
+void BufferPoolManagerInstance::RefillFreeList(std::unique_lock<std::mutex> *lock) {
+  size_t target = FreeFrameTarget();
+  size_t second_chances = 0;
+  std::vector<frame_id_t> victims;
+  while (free_list_.size() + victims.size() < target) {
+    frame_id_t victim;
+    if (!replacer_->Victim(&victim)) {
+      break;
+    }
+    if (static_cast<size_t>(victim) >= pool_size_ || !TryClaimFrame(victim)) {
+      continue;
+    }
+    Page *page = &pages_[victim];
+    if (page->is_dirty_ || page->io_in_progress_) {
+      // Not cleaned yet; hand it back and leave it to the next pass or to a foreground eviction.
+      page->pin_count_ = 0;
+      replacer_->Unpin(victim);
+      break;
+    }
+    if (second_chances < pool_size_ && GiveSecondChance(victim)) {
+      ++second_chances;
+      continue;
+    }
+    victims.push_back(victim);
+  }
+
+  if (compressed_cache_ != nullptr && !victims.empty()) {
+    // The victims stay claimed and mapped while they are compressed; fetches of them wait like for a write-back.
+    for (auto victim : victims) {
+      pages_[victim].io_in_progress_ = true;
+    }
+    lock->unlock();
+    for (auto victim : victims) {
+      compressed_cache_->Insert(pages_[victim].page_id_, pages_[victim].GetData());
+    }
+    lock->lock();
+    for (auto victim : victims) {
+      FinishIo(victim);
     }
   }
-    
-  return true; 
+  for (auto victim : victims) {
+    Page *page = &pages_[victim];
+    page_table_.Erase(page->page_id_);
+    page->page_id_ = INVALID_PAGE_ID;
+    page->BumpVersion();
+    stats_.Add(BufferPoolCounter::CLEAN_EVICTIONS);
+    ReturnFreeFrame(victim);
+  }
+}
+
+void BufferPoolManagerInstance::ReadPageData(page_id_t page_id, char *data, IoClass io_class) {
+  if (compressed_cache_ == nullptr || !compressed_cache_->Lookup(page_id, data)) {
+    disk_manager_->GetIoScheduler()->Run(io_class, 1, [&] { disk_manager_->ReadPage(page_id, data); });
+  }
+}
+
+void BufferPoolManagerInstance::ReadSortedPages(const std::vector<frame_id_t> &frames) {
+  std::vector<char *> run;
+  page_id_t first_page_id = INVALID_PAGE_ID;
+  auto read_run = [&] {
+    if (!run.empty()) {
+      disk_manager_->GetIoScheduler()->Run(IoClass::DEMAND, run.size(),
+                                           [&] { disk_manager_->ReadPages(first_page_id, run.data(), run.size()); });
+      run.clear();
+    }
+  };
+  for (auto frame_id : frames) {
+    Page *page = &pages_[frame_id];
+    if (compressed_cache_ != nullptr && compressed_cache_->Lookup(page->page_id_, page->GetData())) {
+      continue;
+    }
+    if (run.size() == FLUSH_MAX_RUN || page->page_id_ != first_page_id + static_cast<page_id_t>(run.size())) {
+      read_run();
+    }
+    if (run.empty()) {
+      first_page_id = page->page_id_;
+    }
+    run.push_back(page->GetData());
+  }
+  read_run();
+}
+
+auto BufferPoolManagerInstance::FreeFrameTarget() const -> size_t {
+  return std::min<size_t>(page_cleaner_free_frames, pool_size_ / 4);
+}
+
+void BufferPoolManagerInstance::WaitForIo(std::unique_lock<std::mutex> *lock, frame_id_t frame_id) {
+  io_cv_[frame_id].wait(*lock, [&] { return !pages_[frame_id].io_in_progress_; });
+}
+
+void BufferPoolManagerInstance::FinishIo(frame_id_t frame_id) {
+  pages_[frame_id].io_in_progress_ = false;
+  io_cv_[frame_id].notify_all();
 }
 
-auto BufferPoolManagerInstance::AllocatePage() -> page_id_t {
-  const page_id_t next_page_id = next_page_id_;
-  next_page_id_ += num_instances_;
+auto BufferPoolManagerInstance::AllocatePage(bool *reused) -> page_id_t {
+  const page_id_t next_page_id = free_page_map_.Allocate(reused);
   ValidatePageId(next_page_id);
   return next_page_id;
 }
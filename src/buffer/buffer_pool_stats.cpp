@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace bustub {
+
+void BufferPoolStats::Merge(const BufferPoolStats &other) {
+  hits_ += other.hits_;
+  misses_ += other.misses_;
+  clean_evictions_ += other.clean_evictions_;
+  dirty_evictions_ += other.dirty_evictions_;
+  write_backs_ += other.write_backs_;
+  latch_wait_ns_ += other.latch_wait_ns_;
+  free_frames_ += other.free_frames_;
+  pinned_high_water_ += other.pinned_high_water_;
+  for (size_t i = 0; i < NUM_LATENCY_BUCKETS; ++i) {
+    miss_latency_[i] += other.miss_latency_[i];
+  }
+  compressed_cache_hits_ += other.compressed_cache_hits_;
+  compressed_cache_misses_ += other.compressed_cache_misses_;
+  compressed_cache_insertions_ += other.compressed_cache_insertions_;
+  compressed_cache_rejections_ += other.compressed_cache_rejections_;
+  compressed_cache_evictions_ += other.compressed_cache_evictions_;
+  compressed_cache_pages_ += other.compressed_cache_pages_;
+  compressed_cache_bytes_ += other.compressed_cache_bytes_;
+}
+
+auto BufferPoolStats::HitRatio() const -> double {
+  uint64_t fetches = hits_ + misses_;
+  return fetches == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(fetches);
+}
+
+auto BufferPoolStats::MissLatencyPercentile(double percentile) const -> uint64_t {
+  uint64_t total = 0;
+  for (auto count : miss_latency_) {
+    total += count;
+  }
+  if (total == 0) {
+    return 0;
+  }
+  auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(static_cast<double>(total) * percentile / 100 + 0.5));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < NUM_LATENCY_BUCKETS; ++i) {
+    seen += miss_latency_[i];
+    if (seen >= rank) {
+      return static_cast<uint64_t>(1) << i;
+    }
+  }
+  return static_cast<uint64_t>(1) << (NUM_LATENCY_BUCKETS - 1);
+}
+
+auto BufferPoolStats::ToString() const -> std::string {
+  std::ostringstream os;
+  os << "hits: " << hits_ << ", misses: " << misses_ << ", hit ratio: " << HitRatio() << "\n";
+  os << "evictions: " << clean_evictions_ << " clean, " << dirty_evictions_ << " dirty, write-backs: " << write_backs_
+     << "\n";
+  os << "free frames: " << free_frames_ << ", pinned high-water: " << pinned_high_water_
+     << ", latch wait: " << latch_wait_ns_ / 1000 << " us\n";
+  os << "miss latency: p50 < " << MissLatencyPercentile(50) << " us, p99 < " << MissLatencyPercentile(99)
+     << " us, max < " << MissLatencyPercentile(100) << " us\n";
+  if (compressed_cache_insertions_ + compressed_cache_rejections_ != 0) {
+    os << "compressed cache: " << compressed_cache_hits_ << " hits, " << compressed_cache_misses_ << " misses, "
+       << compressed_cache_pages_ << " pages in " << compressed_cache_bytes_ << " bytes, "
+       << compressed_cache_rejections_ << " rejected, " << compressed_cache_evictions_ << " evicted\n";
+  }
+  return os.str();
+}
+
+auto BufferPoolStats::LatencyBucket(uint64_t latency_us) -> size_t {
+  size_t bucket = 0;
+  while (latency_us != 0 && bucket < NUM_LATENCY_BUCKETS - 1) {
+    latency_us >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+void BufferPoolCounters::Collect(BufferPoolStats *stats) const {
+  for (const auto &stripe : stripes_) {
+    auto counter = [&](BufferPoolCounter c) {
+      return stripe.counters_[static_cast<size_t>(c)].load(std::memory_order_relaxed);
+    };
+    stats->hits_ += counter(BufferPoolCounter::HITS);
+    stats->misses_ += counter(BufferPoolCounter::MISSES);
+    stats->clean_evictions_ += counter(BufferPoolCounter::CLEAN_EVICTIONS);
+    stats->dirty_evictions_ += counter(BufferPoolCounter::DIRTY_EVICTIONS);
+    stats->write_backs_ += counter(BufferPoolCounter::WRITE_BACKS);
+    stats->latch_wait_ns_ += counter(BufferPoolCounter::LATCH_WAIT_NS);
+    for (size_t i = 0; i < BufferPoolStats::NUM_LATENCY_BUCKETS; ++i) {
+      stats->miss_latency_[i] += stripe.miss_latency_[i].load(std::memory_order_relaxed);
+    }
+  }
+}
+
+}  // namespace bustub
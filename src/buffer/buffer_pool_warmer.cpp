@@ -0,0 +1,143 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_warmer.cpp
+//
+// Identification: src/buffer/buffer_pool_warmer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_warmer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+BufferPoolWarmer::~BufferPoolWarmer() { StopWarmupThread(); }
+
+void BufferPoolWarmer::RunWarmupThread() {
+  std::scoped_lock latch(latch_);
+  if (warmup_thread_ != nullptr) {
+    return;
+  }
+  stop_ = false;
+  warmup_thread_ = new std::thread(&BufferPoolWarmer::RunWarmup, this);
+}
+
+void BufferPoolWarmer::StopWarmupThread() {
+  {
+    std::scoped_lock latch(latch_);
+    if (warmup_thread_ == nullptr) {
+      return;
+    }
+    stop_ = true;
+  }
+  cv_.notify_one();
+  warmup_thread_->join();
+  delete warmup_thread_;
+  warmup_thread_ = nullptr;
+  Save();
+}
+
+void BufferPoolWarmer::RunWarmup() {
+  Load();
+  std::unique_lock<std::mutex> latch(latch_);
+  while (!cv_.wait_for(latch, warmup_save_interval, [&] { return stop_; })) {
+    latch.unlock();
+    Save();
+    latch.lock();
+  }
+}
+
+auto BufferPoolWarmer::Save() -> bool {
+  std::vector<page_id_t> page_ids = buffer_pool_manager_->GetResidentPages();
+  std::vector<std::pair<page_id_t, uint32_t>> entries;
+  entries.reserve(page_ids.size());
+  for (size_t rank = 0; rank < page_ids.size(); ++rank) {
+    entries.emplace_back(page_ids[rank], static_cast<uint32_t>(rank));
+  }
+  std::sort(entries.begin(), entries.end());
+
+  std::string tmp_file_name = file_name_ + ".tmp";
+  std::ofstream out(tmp_file_name, std::ios::binary | std::ios::trunc | std::ios::out);
+  uint32_t header[2] = {MAGIC, static_cast<uint32_t>(entries.size())};
+  out.write(reinterpret_cast<const char *>(header), sizeof(header));
+  for (const auto &[page_id, rank] : entries) {
+    out.write(reinterpret_cast<const char *>(&page_id), sizeof(page_id));
+    out.write(reinterpret_cast<const char *>(&rank), sizeof(rank));
+  }
+  out.close();
+  if (out.fail() || std::rename(tmp_file_name.c_str(), file_name_.c_str()) != 0) {
+    LOG_DEBUG("can't write the warm-up file %s", file_name_.c_str());
+    return false;
+  }
+  return true;
+}
+
+auto BufferPoolWarmer::Load() -> size_t {
+  std::ifstream in(file_name_, std::ios::binary | std::ios::in);
+  uint32_t header[2];
+  if (!in.read(reinterpret_cast<char *>(header), sizeof(header)) || header[0] != MAGIC) {
+    return 0;
+  }
+  std::vector<std::pair<uint32_t, page_id_t>> entries;
+  entries.reserve(header[1]);
+  for (uint32_t i = 0; i < header[1]; ++i) {
+    page_id_t page_id;
+    uint32_t rank;
+    if (!in.read(reinterpret_cast<char *>(&page_id), sizeof(page_id)) ||
+        !in.read(reinterpret_cast<char *>(&rank), sizeof(rank))) {
+      break;
+    }
+    entries.emplace_back(rank, page_id);
+  }
+
+  // Keep the most recently used pages that fit, then read them in page id order.
+  size_t pool_size = buffer_pool_manager_->GetPoolSize();
+  if (entries.size() > pool_size) {
+    std::nth_element(entries.begin(), entries.begin() + pool_size, entries.end());
+    entries.resize(pool_size);
+  }
+  std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) { return a.second < b.second; });
+
+  size_t loaded = 0;
+  page_id_t page_ids[WARMUP_BATCH_SIZE];
+  Page *pages[WARMUP_BATCH_SIZE];
+  for (size_t begin = 0; begin < entries.size(); begin += WARMUP_BATCH_SIZE) {
+    {
+      std::scoped_lock latch(latch_);
+      if (stop_) {
+        break;
+      }
+    }
+    size_t num_pages = std::min<size_t>(WARMUP_BATCH_SIZE, entries.size() - begin);
+    for (size_t i = 0; i < num_pages; ++i) {
+      page_ids[i] = entries[begin + i].second;
+    }
+    buffer_pool_manager_->FetchPages(page_ids, num_pages, pages);
+
+    // Unpin the coldest pages of the batch first, so that the replacer sees the hottest ones as most recently used.
+    std::vector<size_t> order(num_pages);
+    for (size_t i = 0; i < num_pages; ++i) {
+      order[i] = i;
+    }
+    std::sort(order.begin(), order.end(),
+              [&](size_t a, size_t b) { return entries[begin + a].first > entries[begin + b].first; });
+    for (auto i : order) {
+      if (pages[i] != nullptr) {
+        buffer_pool_manager_->UnpinPage(page_ids[i], false);
+        loaded++;
+      }
+    }
+  }
+  return loaded;
+}
+
+}  // namespace bustub
@@ -14,16 +14,74 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : num_pages_(num_pages), in_replacer_(num_pages), ref_(num_pages) {
+  for (size_t i = 0; i < num_pages; ++i) {
+    in_replacer_[i].store(false);
+    ref_[i].store(false);
+  }
+}
 
 ClockReplacer::~ClockReplacer() = default;
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool {
+  // Each full sweep clears the reference bits it passes, so a victim is found within two sweeps unless concurrent
+  // unpins keep setting them again; re-check the size after every sweep instead of looping forever.
+  while (size_.load() > 0) {
+    for (size_t step = 0; step < 2 * num_pages_; ++step) {
+      auto candidate = static_cast<frame_id_t>(hand_.fetch_add(1) % num_pages_);
+      if (!in_replacer_[candidate].load()) {
+        continue;
+      }
+      if (ref_[candidate].exchange(false)) {
+        continue;
+      }
+      bool expected = true;
+      if (in_replacer_[candidate].compare_exchange_strong(expected, false)) {
+        size_--;
+        *frame_id = candidate;
+        return true;
+      }
+    }
+  }
+  *frame_id = INVALID_PAGE_ID;
+  return false;
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  if (in_replacer_[frame_id].exchange(false)) {
+    size_--;
+  }
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  ref_[frame_id].store(true);
+  if (in_replacer_[frame_id].load()) {
+    return;
+  }
+  // Count the frame before publishing it. A Pin or Victim only uncounts a frame after taking its flag, so the count
+  // never drops below zero, and is at most briefly too high while an unpin that lost the race takes its count back.
+  size_++;
+  bool expected = false;
+  if (!in_replacer_[frame_id].compare_exchange_strong(expected, true)) {
+    size_--;
+  }
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+auto ClockReplacer::Size() -> size_t { return size_.load(); }
+
+auto ClockReplacer::EvictionOrder() -> std::vector<frame_id_t> {
+  // A snapshot in the order of the next sweep: frames without their reference bit go first, then the others.
+  std::vector<frame_id_t> order;
+  size_t hand = hand_.load();
+  for (bool referenced : {false, true}) {
+    for (size_t step = 0; step < num_pages_; ++step) {
+      auto frame_id = static_cast<frame_id_t>((hand + step) % num_pages_);
+      if (in_replacer_[frame_id].load() && ref_[frame_id].load() == referenced) {
+        order.push_back(frame_id);
+      }
+    }
+  }
+  return order;
+}
 
 }  // namespace bustub
@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.cpp
+//
+// Identification: src/buffer/compressed_page_cache.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include <iterator>
+
+#include "common/util/lz_util.h"
+
+namespace bustub {
+
+void CompressedPageCache::Insert(page_id_t page_id, const char *data) {
+  // Compress before taking the latch, so that evictions of several threads compress in parallel.
+  char buffer[MAX_COMPRESSED_SIZE];
+  size_t size = LZUtil::Compress(data, PAGE_SIZE, buffer, sizeof(buffer));
+  std::scoped_lock latch(latch_);
+  auto it = index_.find(page_id);
+  if (it != index_.end()) {
+    Remove(it->second);
+  }
+  if (size == 0 || size > capacity_) {
+    rejections_++;
+    return;
+  }
+  while (size_ + size > capacity_) {
+    Remove(std::prev(entries_.end()));
+    evictions_++;
+  }
+  entries_.push_front({page_id, std::string(buffer, size)});
+  index_[page_id] = entries_.begin();
+  size_ += size;
+  insertions_++;
+}
+
+auto CompressedPageCache::Lookup(page_id_t page_id, char *data) -> bool {
+  std::scoped_lock latch(latch_);
+  auto it = index_.find(page_id);
+  if (it == index_.end()) {
+    misses_++;
+    return false;
+  }
+  const std::string &compressed = it->second->data_;
+  bool restored = LZUtil::Decompress(compressed.data(), compressed.size(), data, PAGE_SIZE);
+  BUSTUB_ASSERT(restored, "a cached page must decompress to a full page");
+  Remove(it->second);
+  hits_++;
+  return true;
+}
+
+void CompressedPageCache::Erase(page_id_t page_id) {
+  std::scoped_lock latch(latch_);
+  auto it = index_.find(page_id);
+  if (it != index_.end()) {
+    Remove(it->second);
+  }
+}
+
+auto CompressedPageCache::GetSize() -> size_t {
+  std::scoped_lock latch(latch_);
+  return size_;
+}
+
+void CompressedPageCache::Collect(BufferPoolStats *stats) {
+  stats->compressed_cache_hits_ += hits_;
+  stats->compressed_cache_misses_ += misses_;
+  stats->compressed_cache_insertions_ += insertions_;
+  stats->compressed_cache_rejections_ += rejections_;
+  stats->compressed_cache_evictions_ += evictions_;
+  std::scoped_lock latch(latch_);
+  stats->compressed_cache_pages_ += entries_.size();
+  stats->compressed_cache_bytes_ += size_;
+}
+
+void CompressedPageCache::Remove(std::list<Entry>::iterator it) {
+  size_ -= it->data_.size();
+  index_.erase(it->page_id_);
+  entries_.erase(it);
+}
+
+}  // namespace bustub
@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+#include <cstdint>
+
+#include "common/exception.h"
+#include "common/util/numa_util.h"
+
+namespace bustub {
+
+FrameArena::FrameArena(size_t num_frames, uint32_t numa_node) {
+  size_ = (num_frames * PAGE_SIZE + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  if (size_ == 0) {
+    size_ = HUGE_PAGE_SIZE;
+  }
+
+#ifdef MAP_HUGETLB
+  void *huge_mapping = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (huge_mapping != MAP_FAILED) {
+    base_ = static_cast<char *>(huge_mapping);
+    huge_tlb_ = true;
+    NumaUtil::BindToNode(base_, size_, numa_node);
+    return;
+  }
+#endif
+
+  // No huge pages are reserved. Map one huge page more than needed and trim the mapping to a huge page boundary, so
+  // that the kernel can back the whole arena with transparent huge pages.
+  void *mapping = mmap(nullptr, size_ + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapping == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map the frame arena");
+  }
+  auto start = reinterpret_cast<uintptr_t>(mapping);
+  auto aligned = (start + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  size_t head = aligned - start;
+  size_t tail = HUGE_PAGE_SIZE - head;
+  if (head > 0) {
+    munmap(mapping, head);
+  }
+  if (tail > 0) {
+    munmap(reinterpret_cast<void *>(aligned + size_), tail);
+  }
+  base_ = reinterpret_cast<char *>(aligned);
+#ifdef MADV_HUGEPAGE
+  madvise(base_, size_, MADV_HUGEPAGE);
+#endif
+  NumaUtil::BindToNode(base_, size_, numa_node);
+}
+
+FrameArena::~FrameArena() { munmap(base_, size_); }
+
+void FrameArena::Release(size_t first_frame_id, size_t num_frames) {
+  char *begin = GetFrame(first_frame_id);
+  char *end = GetFrame(first_frame_id + num_frames);
+  if (huge_tlb_) {
+    // Explicit huge pages can only be dropped as a whole.
+    auto huge_begin = (reinterpret_cast<uintptr_t>(begin) + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    auto huge_end = reinterpret_cast<uintptr_t>(end) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    if (huge_begin >= huge_end) {
+      return;
+    }
+    begin = reinterpret_cast<char *>(huge_begin);
+    end = reinterpret_cast<char *>(huge_end);
+  }
+  madvise(begin, end - begin, MADV_DONTNEED);
+}
+
+}  // namespace bustub
@@ -0,0 +1,107 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k)
+    : k_(k), history_(num_pages * k, 0), access_count_(num_pages, 0), evictable_(num_pages, false) {
+  BUSTUB_ASSERT(k > 0, "LRU-K needs to remember at least one access");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+auto LRUKReplacer::Victim(frame_id_t *frame_id) -> bool {
+  std::scoped_lock latch(latch_);
+  std::set<Entry> *source = !history_set_.empty() ? &history_set_ : &cache_set_;
+  if (source->empty()) {
+    *frame_id = INVALID_PAGE_ID;
+    return false;
+  }
+  *frame_id = source->begin()->second;
+  source->erase(source->begin());
+  evictable_[*frame_id] = false;
+  access_count_[*frame_id] = 0;
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  Erase(frame_id);
+  size_t count = access_count_[frame_id]++;
+  history_[frame_id * k_ + count % k_] = current_timestamp_++;
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  if (evictable_[frame_id]) {
+    return;
+  }
+  evictable_[frame_id] = true;
+  if (access_count_[frame_id] < k_) {
+    history_set_.insert(Key(frame_id));
+  } else {
+    cache_set_.insert(Key(frame_id));
+  }
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  Erase(frame_id);
+  access_count_[frame_id] = 0;
+}
+
+auto LRUKReplacer::Size() -> size_t {
+  std::scoped_lock latch(latch_);
+  return history_set_.size() + cache_set_.size();
+}
+
+auto LRUKReplacer::EvictionOrder() -> std::vector<frame_id_t> {
+  std::scoped_lock latch(latch_);
+  std::vector<frame_id_t> order;
+  order.reserve(history_set_.size() + cache_set_.size());
+  for (const auto &entry : history_set_) {
+    order.push_back(entry.second);
+  }
+  for (const auto &entry : cache_set_) {
+    order.push_back(entry.second);
+  }
+  return order;
+}
+
+auto LRUKReplacer::Key(frame_id_t frame_id) const -> Entry {
+  size_t count = access_count_[frame_id];
+  if (count == 0) {
+    // Never accessed since it was loaded, e.g. a page read ahead that nobody fetched: the first to go.
+    return {0, frame_id};
+  }
+  // Below k accesses the oldest timestamp sits in slot 0; afterwards the next slot to overwrite holds it.
+  size_t slot = count < k_ ? 0 : count % k_;
+  return {history_[frame_id * k_ + slot], frame_id};
+}
+
+void LRUKReplacer::Erase(frame_id_t frame_id) {
+  if (!evictable_[frame_id]) {
+    return;
+  }
+  evictable_[frame_id] = false;
+  if (access_count_[frame_id] < k_) {
+    history_set_.erase(Key(frame_id));
+  } else {
+    cache_set_.erase(Key(frame_id));
+  }
+}
+
+}  // namespace bustub
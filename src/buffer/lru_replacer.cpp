@@ -14,37 +14,69 @@
 
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {}
+LRUReplacer::LRUReplacer(size_t num_pages)
+    : sentinel_(static_cast<frame_id_t>(num_pages)),
+      prev_(num_pages + 1, NOT_IN_LIST),
+      next_(num_pages + 1, NOT_IN_LIST) {
+  prev_[sentinel_] = sentinel_;
+  next_[sentinel_] = sentinel_;
+}
 
 LRUReplacer::~LRUReplacer() = default;
 
-auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool { 
-    std::unique_lock<std::mutex> latch(latch_);
-
-    if(frame_list_.empty()) {
-        *frame_id = INVALID_PAGE_ID;
-        return false;
-    }
-    *frame_id = frame_list_.front();
-    frame_list_.pop_front();
-
-    return true;
+auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool {
+  std::scoped_lock latch(latch_);
+  if (size_ == 0) {
+    *frame_id = INVALID_PAGE_ID;
+    return false;
+  }
+  *frame_id = next_[sentinel_];
+  Unlink(*frame_id);
+  return true;
 }
 
 void LRUReplacer::Pin(frame_id_t frame_id) {
-    std::unique_lock<std::mutex> latch(latch_);
-    auto it = std::find(frame_list_.begin(), frame_list_.end(), frame_id);
-    if(it !=  frame_list_.end())
-        frame_list_.erase(it);
+  std::scoped_lock latch(latch_);
+  if (next_[frame_id] != NOT_IN_LIST) {
+    Unlink(frame_id);
+  }
 }
 
 void LRUReplacer::Unpin(frame_id_t frame_id) {
-    std::unique_lock<std::mutex> latch(latch_);
-    auto it = std::find(frame_list_.begin(), frame_list_.end(), frame_id);
-    if(it ==  frame_list_.end())
-        frame_list_.push_back(frame_id);
+  std::scoped_lock latch(latch_);
+  if (next_[frame_id] != NOT_IN_LIST) {
+    return;
+  }
+  // Append as the most recently used frame, i.e. just before the sentinel.
+  frame_id_t last = prev_[sentinel_];
+  prev_[frame_id] = last;
+  next_[frame_id] = sentinel_;
+  next_[last] = frame_id;
+  prev_[sentinel_] = frame_id;
+  size_++;
+}
+
+auto LRUReplacer::Size() -> size_t {
+  std::scoped_lock latch(latch_);
+  return size_;
+}
+
+auto LRUReplacer::EvictionOrder() -> std::vector<frame_id_t> {
+  std::scoped_lock latch(latch_);
+  std::vector<frame_id_t> order;
+  order.reserve(size_);
+  for (frame_id_t frame_id = next_[sentinel_]; frame_id != sentinel_; frame_id = next_[frame_id]) {
+    order.push_back(frame_id);
+  }
+  return order;
 }
 
-auto LRUReplacer::Size() -> size_t { return frame_list_.size(); }
+void LRUReplacer::Unlink(frame_id_t frame_id) {
+  next_[prev_[frame_id]] = next_[frame_id];
+  prev_[next_[frame_id]] = prev_[frame_id];
+  prev_[frame_id] = NOT_IN_LIST;
+  next_[frame_id] = NOT_IN_LIST;
+  size_--;
+}
 
 }  // namespace bustub
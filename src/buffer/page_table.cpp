@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames) : slots_(0) {
+  size_t capacity = 2;
+  while (capacity < 2 * num_frames) {
+    capacity <<= 1;
+  }
+  slots_ = std::vector<std::atomic<uint64_t>>(capacity);
+  for (auto &slot : slots_) {
+    slot.store(EMPTY, std::memory_order_relaxed);
+  }
+  mask_ = capacity - 1;
+}
+
+auto PageTable::Home(page_id_t page_id) const -> size_t {
+  // Page ids of one instance are strided by the number of instances, so mix them before masking.
+  return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >> 32) &
+         mask_;
+}
+
+auto PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const -> bool {
+  size_t i = Home(page_id);
+  for (size_t probes = 0; probes <= mask_; ++probes, i = (i + 1) & mask_) {
+    uint64_t entry = slots_[i].load(std::memory_order_acquire);
+    if (entry == EMPTY) {
+      return false;
+    }
+    if (PageOf(entry) == page_id) {
+      *frame_id = FrameOf(entry);
+      return true;
+    }
+  }
+  return false;
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  size_t i = Home(page_id);
+  while (true) {
+    uint64_t entry = slots_[i].load(std::memory_order_relaxed);
+    if (entry == EMPTY || PageOf(entry) == page_id) {
+      if (entry == EMPTY) {
+        size_.fetch_add(1, std::memory_order_relaxed);
+      }
+      slots_[i].store(Pack(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+    i = (i + 1) & mask_;
+  }
+}
+
+auto PageTable::Erase(page_id_t page_id) -> bool {
+  size_t hole = Home(page_id);
+  while (true) {
+    uint64_t entry = slots_[hole].load(std::memory_order_relaxed);
+    if (entry == EMPTY) {
+      return false;
+    }
+    if (PageOf(entry) == page_id) {
+      break;
+    }
+    hole = (hole + 1) & mask_;
+  }
+  size_.fetch_sub(1, std::memory_order_relaxed);
+
+  // Backward shift: move every following entry of the probe run that may live in the hole into it, so that no
+  // tombstones pile up. The erased entry disappears with the first store; a lookup racing with the later moves may
+  // miss a moved entry, which the class comment allows.
+  size_t i = hole;
+  while (true) {
+    i = (i + 1) & mask_;
+    uint64_t entry = slots_[i].load(std::memory_order_relaxed);
+    if (entry == EMPTY) {
+      break;
+    }
+    size_t home = Home(PageOf(entry));
+    // The entry may move to the hole unless its home lies cyclically in (hole, i].
+    if (((i - home) & mask_) >= ((i - hole) & mask_)) {
+      slots_[hole].store(entry, std::memory_order_release);
+      hole = i;
+    }
+  }
+  slots_[hole].store(EMPTY, std::memory_order_release);
+  return true;
+}
+
+void PageTable::ForEach(const std::function<void(page_id_t, frame_id_t)> &fn) const {
+  for (const auto &slot : slots_) {
+    uint64_t entry = slot.load(std::memory_order_relaxed);
+    if (entry != EMPTY) {
+      fn(PageOf(entry), FrameOf(entry));
+    }
+  }
+}
+
+}  // namespace bustub
@@ -11,18 +11,33 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/parallel_buffer_pool_manager.h"
+#include <algorithm>
+#include <thread>  // NOLINT
 #include "buffer/buffer_pool_manager_instance.h"
+#include "common/util/numa_util.h"
 
 namespace bustub {
 
 ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager)
-  : pool_size_(pool_size),
-    num_instances_(num_instances),
-    vec_BPMIs(num_instances) {
+                                                     LogManager *log_manager, ReplacerPolicy replacer_policy,
+                                                     size_t max_pool_size)
+  : num_instances_(num_instances),
+    vec_BPMIs(num_instances),
+    disk_manager_(disk_manager),
+    allocation_cursors_(NUM_ALLOCATION_CURSORS) {
     // Allocate and create individual BufferPoolManagerInstances
     for(uint32_t i =0;i < num_instances;i++) {
-      vec_BPMIs[i] = new BufferPoolManagerInstance(pool_size, num_instances, i, disk_manager, log_manager);
+      auto *bpmi = new BufferPoolManagerInstance(pool_size, num_instances, i, disk_manager, log_manager,
+                                                 replacer_policy, max_pool_size);
+      vec_BPMIs[i] = bpmi;
+      if (bpmi->GetNumaNode() >= node_instances_.size()) {
+        node_instances_.resize(bpmi->GetNumaNode() + 1);
+      }
+      node_instances_[bpmi->GetNumaNode()].push_back(i);
+    }
+    // Cursors start at different instances so that threads allocating at the same time do not pile onto one.
+    for (size_t i = 0; i < allocation_cursors_.size(); ++i) {
+      allocation_cursors_[i].next_ = static_cast<uint32_t>(i);
     }
  }
 
@@ -35,7 +50,49 @@ ParallelBufferPoolManager::~ParallelBufferPoolManager() {
 
 auto ParallelBufferPoolManager::GetPoolSize() -> size_t {
   // Get size of all BufferPoolManagerInstances
-  return pool_size_*num_instances_;
+  size_t pool_size = 0;
+  for (auto &bpmi : vec_BPMIs) {
+    pool_size += bpmi->GetPoolSize();
+  }
+  return pool_size;
+}
+
+void ParallelBufferPoolManager::GetResidentPgsImp(std::vector<page_id_t> *page_ids) {
+  std::vector<std::vector<page_id_t>> resident(num_instances_);
+  size_t longest = 0;
+  for (uint32_t i = 0; i < num_instances_; ++i) {
+    resident[i] = vec_BPMIs[i]->GetResidentPages();
+    longest = std::max(longest, resident[i].size());
+  }
+  for (size_t rank = 0; rank < longest; ++rank) {
+    for (const auto &instance_page_ids : resident) {
+      if (rank < instance_page_ids.size()) {
+        page_ids->push_back(instance_page_ids[rank]);
+      }
+    }
+  }
+}
+
+void ParallelBufferPoolManager::GetStatsImp(BufferPoolStats *stats) {
+  for (auto &bpmi : vec_BPMIs) {
+    stats->Merge(bpmi->GetStats());
+  }
+}
+
+auto ParallelBufferPoolManager::ResizeImp(size_t pool_size) -> bool {
+  auto share = [&](uint32_t i) { return pool_size / num_instances_ + (i < pool_size % num_instances_ ? 1 : 0); };
+  // Check every share first, so that a refused resize leaves all instances alone.
+  for (uint32_t i = 0; i < num_instances_; ++i) {
+    if (share(i) == 0 || share(i) > static_cast<BufferPoolManagerInstance *>(vec_BPMIs[i])->GetMaxPoolSize()) {
+      return false;
+    }
+  }
+  // An instance that gives up waiting for its pages keeps its old size; the others are still resized.
+  bool resized = true;
+  for (uint32_t i = 0; i < num_instances_; ++i) {
+    resized = vec_BPMIs[i]->Resize(share(i)) && resized;
+  }
+  return resized;
 }
 
 auto ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) -> BufferPoolManager * {
@@ -48,6 +105,69 @@ auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) -> Page * {
   return GetBufferPoolManager(page_id)->FetchPage(page_id);
 }
 
+auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+  // The ring of a strategy may hold frames of several instances; each instance only recycles its own.
+  return GetBufferPoolManager(page_id)->FetchPageWithStrategy(page_id, strategy);
+}
+
+auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id, PagePriority priority) -> Page * {
+  return GetBufferPoolManager(page_id)->FetchPageWithPriority(page_id, priority);
+}
+
+auto ParallelBufferPoolManager::FetchPgOptimisticImp(page_id_t page_id, uint64_t *version) -> Page * {
+  return GetBufferPoolManager(page_id)->FetchPageOptimistic(page_id, version);
+}
+
+auto ParallelBufferPoolManager::FetchResidentPgImp(page_id_t page_id) -> Page * {
+  return GetBufferPoolManager(page_id)->FetchResidentPage(page_id);
+}
+
+void ParallelBufferPoolManager::PrefetchPgImp(page_id_t page_id) {
+  GetBufferPoolManager(page_id)->PrefetchPage(page_id);
+}
+
+auto ParallelBufferPoolManager::FetchPgsImp(const page_id_t *page_ids, size_t num_pages, Page **pages) -> bool {
+  // Group the requests by instance so that every instance takes its latch once for the whole group.
+  std::vector<std::vector<size_t>> groups(num_instances_);
+  for (size_t i = 0; i < num_pages; ++i) {
+    groups[page_ids[i] % num_instances_].push_back(i);
+  }
+  bool fetched_all = true;
+  std::vector<page_id_t> group_page_ids;
+  std::vector<Page *> group_pages;
+  for (uint32_t instance = 0; instance < num_instances_; ++instance) {
+    if (groups[instance].empty()) {
+      continue;
+    }
+    group_page_ids.clear();
+    for (auto i : groups[instance]) {
+      group_page_ids.push_back(page_ids[i]);
+    }
+    group_pages.resize(group_page_ids.size());
+    fetched_all = vec_BPMIs[instance]->FetchPages(group_page_ids.data(), group_page_ids.size(), group_pages.data()) &&
+                  fetched_all;
+    for (size_t j = 0; j < group_pages.size(); ++j) {
+      pages[groups[instance][j]] = group_pages[j];
+    }
+  }
+  return fetched_all;
+}
+
+auto ParallelBufferPoolManager::UnpinPgsImp(const page_id_t *page_ids, size_t num_pages, bool is_dirty) -> bool {
+  std::vector<std::vector<page_id_t>> groups(num_instances_);
+  for (size_t i = 0; i < num_pages; ++i) {
+    groups[page_ids[i] % num_instances_].push_back(page_ids[i]);
+  }
+  bool unpinned_all = true;
+  for (uint32_t instance = 0; instance < num_instances_; ++instance) {
+    if (!groups[instance].empty()) {
+      unpinned_all = vec_BPMIs[instance]->UnpinPages(groups[instance].data(), groups[instance].size(), is_dirty) &&
+                     unpinned_all;
+    }
+  }
+  return unpinned_all;
+}
+
 auto ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
   // Unpin page_id from responsible BufferPoolManagerInstance
   return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
@@ -59,24 +179,27 @@ auto ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) -> bool {
 }
 
 auto ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) -> Page * {
+  return NewPgImp(page_id, PagePriority::NORMAL);
+}
+
+auto ParallelBufferPoolManager::NewPgImp(page_id_t *page_id, PagePriority priority) -> Page * {
   // create new page. We will request page allocation in a round robin manner from the underlying
-  // BufferPoolManagerInstances
-  // 1.   From a starting index of the BPMIs, call NewPageImpl until either 1) success and return 2) looped around to
-  // starting index and return nullptr
-  // 2.   Bump the starting index (mod number of instances) to start search at a different BPMI each time this function
-  // is called
-  std::unique_lock<std::mutex> latch(latch_);
-  uint32_t idx = start_index_;
-  do {
-    auto page = vec_BPMIs[idx % vec_BPMIs.size()]->NewPage(page_id);
-    if (page != nullptr) {
-      start_index_ = (start_index_ + 1) % vec_BPMIs.size();
-      return page;
+  // BufferPoolManagerInstances. Every thread keeps its own cursor, so that allocations do not serialize on a shared
+  // one, and prefers the instances on its own NUMA node, whose frames are local to it.
+  static std::atomic<size_t> next_thread_slot{0};
+  thread_local size_t thread_slot = next_thread_slot++;
+  uint32_t start = allocation_cursors_[thread_slot % allocation_cursors_.size()].next_.fetch_add(1);
+
+  size_t home = NumaUtil::CurrentNode() % node_instances_.size();
+  for (size_t n = 0; n < node_instances_.size(); ++n) {
+    const auto &instances = node_instances_[(home + n) % node_instances_.size()];
+    for (size_t i = 0; i < instances.size(); ++i) {
+      auto page = vec_BPMIs[instances[(start + i) % instances.size()]]->NewPageWithPriority(page_id, priority);
+      if (page != nullptr) {
+        return page;
+      }
     }
-    idx = (idx + 1) % vec_BPMIs.size();
-  } while (idx != start_index_);
-  start_index_ = (start_index_ + 1) % vec_BPMIs.size();
- 
+  }
   return nullptr;
 }
 
@@ -86,10 +209,46 @@ auto ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) -> bool {
 }
 
 void ParallelBufferPoolManager::FlushAllPgsImp() {
-  // flush all pages from all BufferPoolManagerInstances
-  for(auto &bpmi : vec_BPMIs) {
-    bpmi->FlushAllPages();
+  // flush all pages from all BufferPoolManagerInstances. Page ids are striped over the instances, so only a global
+  // sort brings consecutive pages together.
+  std::vector<BufferPoolManagerInstance::DirtyPage> dirty_pages;
+  std::vector<page_id_t> busy_pages;
+  for (auto &bpmi : vec_BPMIs) {
+    static_cast<BufferPoolManagerInstance *>(bpmi)->BeginFlush(&dirty_pages, &busy_pages);
+  }
+  std::sort(dirty_pages.begin(), dirty_pages.end());
+
+  // Split the pages into one contiguous share per thread; a run crossing a share boundary becomes two writes.
+  size_t num_threads = std::min<size_t>(num_instances_, (dirty_pages.size() + FLUSH_MAX_RUN - 1) / FLUSH_MAX_RUN);
+  std::vector<std::thread> threads;
+  std::vector<std::vector<page_id_t>> failed_shares(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    size_t begin = dirty_pages.size() * i / num_threads;
+    size_t end = dirty_pages.size() * (i + 1) / num_threads;
+    threads.emplace_back([&, i, begin, end] {
+      failed_shares[i] =
+          BufferPoolManagerInstance::WriteSortedPages(disk_manager_, dirty_pages.data() + begin, end - begin);
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  // The shares are in page id order, so their failures are too.
+  std::vector<page_id_t> failed_pages;
+  for (auto &share : failed_shares) {
+    failed_pages.insert(failed_pages.end(), share.begin(), share.end());
+  }
+
+  for (auto &bpmi : vec_BPMIs) {
+    static_cast<BufferPoolManagerInstance *>(bpmi)->EndFlush(dirty_pages, failed_pages);
+  }
+  for (auto page_id : busy_pages) {
+    FlushPgImp(page_id);
+  }
+  for (auto &bpmi : vec_BPMIs) {
+    static_cast<BufferPoolManagerInstance *>(bpmi)->FlushFreePageMap();
   }
+  disk_manager_->Sync();
 }
 
 }  // namespace bustub
@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// priority_replacer.cpp
+//
+// Identification: src/buffer/priority_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/priority_replacer.h"
+
+namespace bustub {
+
+PriorityReplacer::PriorityReplacer(Replacer *replacer, size_t num_pages, size_t max_protected)
+    : replacer_(replacer),
+      protected_(num_pages),
+      max_protected_(max_protected),
+      high_(num_pages),
+      in_protected_(num_pages) {}
+
+PriorityReplacer::~PriorityReplacer() { delete replacer_; }
+
+auto PriorityReplacer::Victim(frame_id_t *frame_id) -> bool {
+  if (!replacer_->Victim(frame_id)) {
+    std::scoped_lock latch(latch_);
+    if (!protected_.Victim(frame_id)) {
+      return false;
+    }
+    in_protected_[*frame_id] = false;
+    // The wrapped replacer kept the history of the frame's page, which must not carry over to the next page.
+    replacer_->Remove(*frame_id);
+  }
+  // The frame is about to receive another page. If it is handed back instead, it comes back as a normal frame.
+  high_[*frame_id] = false;
+  return true;
+}
+
+void PriorityReplacer::Pin(frame_id_t frame_id) {
+  // The wrapped replacer sees the accesses to protected frames too, so that their history is current once demoted.
+  replacer_->Pin(frame_id);
+  if (in_protected_[frame_id]) {
+    std::scoped_lock latch(latch_);
+    if (in_protected_[frame_id]) {
+      protected_.Pin(frame_id);
+      in_protected_[frame_id] = false;
+    }
+  }
+}
+
+void PriorityReplacer::Unpin(frame_id_t frame_id) {
+  if (!high_[frame_id]) {
+    replacer_->Unpin(frame_id);
+    return;
+  }
+  std::scoped_lock latch(latch_);
+  if (in_protected_[frame_id]) {
+    return;
+  }
+  protected_.Unpin(frame_id);
+  in_protected_[frame_id] = true;
+  if (protected_.Size() > max_protected_) {
+    // Demote the least recently used protected frame. Its page keeps its priority, so it is protected again the next
+    // time it is unpinned.
+    frame_id_t demoted;
+    protected_.Victim(&demoted);
+    in_protected_[demoted] = false;
+    replacer_->Unpin(demoted);
+  }
+}
+
+void PriorityReplacer::Remove(frame_id_t frame_id) {
+  if (in_protected_[frame_id]) {
+    std::scoped_lock latch(latch_);
+    protected_.Remove(frame_id);
+    in_protected_[frame_id] = false;
+  }
+  replacer_->Remove(frame_id);
+  high_[frame_id] = false;
+}
+
+void PriorityReplacer::SetPriority(frame_id_t frame_id, PagePriority priority) {
+  high_[frame_id] = priority == PagePriority::HIGH;
+}
+
+auto PriorityReplacer::Size() -> size_t {
+  std::scoped_lock latch(latch_);
+  return replacer_->Size() + protected_.Size();
+}
+
+auto PriorityReplacer::EvictionOrder() -> std::vector<frame_id_t> {
+  std::vector<frame_id_t> order = replacer_->EvictionOrder();
+  std::scoped_lock latch(latch_);
+  std::vector<frame_id_t> protected_order = protected_.EvictionOrder();
+  order.insert(order.end(), protected_order.begin(), protected_order.end());
+  return order;
+}
+
+}  // namespace bustub
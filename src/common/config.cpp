@@ -18,6 +18,26 @@ std::atomic<bool> enable_logging(false);
 
 std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
+std::chrono::milliseconds page_cleaner_interval = std::chrono::milliseconds(100);
+
+std::chrono::milliseconds resize_timeout = std::chrono::seconds(10);
+
+std::atomic<size_t> page_cleaner_free_frames(16);
+
+std::atomic<size_t> scan_prefetch_window(4);
+
+std::atomic<size_t> compressed_page_cache_size(0);
+
+std::atomic<bool> enable_direct_io(false);
+
+std::atomic<bool> enable_io_uring(true);
+
+std::atomic<size_t> background_io_rate_limit(0);
+
+std::atomic<bool> enable_buffer_pool_warmup(false);
+
+std::chrono::milliseconds warmup_save_interval = std::chrono::seconds(60);
+
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
 }  // namespace bustub
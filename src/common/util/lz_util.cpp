@@ -0,0 +1,161 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz_util.cpp
+//
+// Identification: src/common/util/lz_util.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/lz_util.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+/** Shortest match worth encoding. */
+constexpr size_t MIN_MATCH = 4;
+/** Farthest a match may reach back, bounded by the two byte offset. */
+constexpr size_t MAX_OFFSET = 65535;
+/** Log2 of the number of entries of the match finder's hash table. */
+constexpr int HASH_BITS = 12;
+/** A length nibble of this value is continued in extra bytes. */
+constexpr size_t LENGTH_MASK = 15;
+
+auto Read32(const uint8_t *p) -> uint32_t {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+}  // namespace
+
+auto LZUtil::Compress(const char *src, size_t src_size, char *dst, size_t dst_capacity) -> size_t {
+  const auto *in = reinterpret_cast<const uint8_t *>(src);
+  auto *out = reinterpret_cast<uint8_t *>(dst);
+  size_t op = 0;
+  bool overflow = false;
+  auto put = [&](uint8_t byte) {
+    if (op < dst_capacity) {
+      out[op++] = byte;
+    } else {
+      overflow = true;
+    }
+  };
+  auto put_length = [&](size_t length) {
+    for (; length >= 255; length -= 255) {
+      put(255);
+    }
+    put(static_cast<uint8_t>(length));
+  };
+  auto put_sequence = [&](size_t anchor, size_t num_literals, size_t offset, size_t match_length) {
+    size_t match_code = match_length == 0 ? 0 : match_length - MIN_MATCH;
+    put(static_cast<uint8_t>((std::min(num_literals, LENGTH_MASK) << 4) | std::min(match_code, LENGTH_MASK)));
+    if (num_literals >= LENGTH_MASK) {
+      put_length(num_literals - LENGTH_MASK);
+    }
+    if (num_literals > dst_capacity - std::min(op, dst_capacity)) {
+      overflow = true;
+      return;
+    }
+    memcpy(out + op, in + anchor, num_literals);
+    op += num_literals;
+    if (match_length == 0) {
+      return;
+    }
+    put(static_cast<uint8_t>(offset & 0xFF));
+    put(static_cast<uint8_t>(offset >> 8));
+    if (match_code >= LENGTH_MASK) {
+      put_length(match_code - LENGTH_MASK);
+    }
+  };
+
+  std::array<uint32_t, 1 << HASH_BITS> table{};
+  size_t anchor = 0;
+  size_t ip = 0;
+  while (ip + MIN_MATCH <= src_size && !overflow) {
+    uint32_t sequence = Read32(in + ip);
+    size_t slot = (sequence * 2654435761U) >> (32 - HASH_BITS);
+    size_t candidate = table[slot];
+    table[slot] = static_cast<uint32_t>(ip);
+    // The table starts out zeroed and is never cleared, so a candidate is only a hint until its bytes are compared.
+    if (candidate >= ip || ip - candidate > MAX_OFFSET || Read32(in + candidate) != sequence) {
+      ip++;
+      continue;
+    }
+    size_t match_length = MIN_MATCH;
+    while (ip + match_length < src_size && in[candidate + match_length] == in[ip + match_length]) {
+      match_length++;
+    }
+    put_sequence(anchor, ip - anchor, ip - candidate, match_length);
+    ip += match_length;
+    anchor = ip;
+  }
+  // The last sequence holds the remaining literals and no match.
+  put_sequence(anchor, src_size - anchor, 0, 0);
+  return overflow ? 0 : op;
+}
+
+auto LZUtil::Decompress(const char *src, size_t src_size, char *dst, size_t dst_size) -> bool {
+  const auto *in = reinterpret_cast<const uint8_t *>(src);
+  auto *out = reinterpret_cast<uint8_t *>(dst);
+  size_t ip = 0;
+  size_t op = 0;
+  auto get_length = [&](size_t *length) {
+    uint8_t byte;
+    do {
+      if (ip == src_size) {
+        return false;
+      }
+      byte = in[ip++];
+      *length += byte;
+    } while (byte == 255);
+    return true;
+  };
+
+  while (ip < src_size) {
+    uint8_t token = in[ip++];
+    size_t num_literals = token >> 4;
+    if (num_literals == LENGTH_MASK && !get_length(&num_literals)) {
+      return false;
+    }
+    if (num_literals > src_size - ip || num_literals > dst_size - op) {
+      return false;
+    }
+    memcpy(out + op, in + ip, num_literals);
+    ip += num_literals;
+    op += num_literals;
+    if (ip == src_size) {
+      break;
+    }
+
+    if (src_size - ip < 2) {
+      return false;
+    }
+    size_t offset = in[ip] | (static_cast<size_t>(in[ip + 1]) << 8);
+    ip += 2;
+    size_t match_length = token & LENGTH_MASK;
+    if (match_length == LENGTH_MASK && !get_length(&match_length)) {
+      return false;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > op || match_length > dst_size - op) {
+      return false;
+    }
+    // Copy byte by byte: the match may overlap the bytes it produces.
+    for (size_t i = 0; i < match_length; ++i, ++op) {
+      out[op] = out[op - offset];
+    }
+  }
+  return op == dst_size;
+}
+
+}  // namespace bustub
@@ -15,6 +15,7 @@
 #include <utility>
 #include <vector>
 
+#include "buffer/optimistic_page_guard.h"
 #include "common/exception.h"
 #include "common/logger.h"
 #include "common/rid.h"
@@ -27,7 +28,7 @@ HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager
                                      const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
     : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
   //  implement me!
-  auto page = buffer_pool_manager->NewPage(&directory_page_id_);
+  auto page = buffer_pool_manager->NewPageWithPriority(&directory_page_id_, PagePriority::HIGH);
   auto directory_page = reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
 
   // remeber update directory page
@@ -77,7 +78,7 @@ inline auto HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage *di
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::FetchDirectoryPage() -> HashTableDirectoryPage * {
-  auto directory_page = buffer_pool_manager_->FetchPage(directory_page_id_);
+  auto directory_page = buffer_pool_manager_->FetchPageWithPriority(directory_page_id_, PagePriority::HIGH);
   BUSTUB_ASSERT(directory_page != nullptr,"directory page cannot be nullptr");
   return reinterpret_cast<HashTableDirectoryPage *>(directory_page->GetData());
 }
@@ -89,14 +90,30 @@ auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> Page * {
   return bucket_page;
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ReadBucketPageId(const KeyType &key) -> page_id_t {
+  uint32_t hash = Hash(key);
+  page_id_t bucket_page_id;
+  OptimisticPageGuard guard(buffer_pool_manager_, directory_page_id_, PagePriority::HIGH);
+  do {
+    auto directory_page = reinterpret_cast<HashTableDirectoryPage *>(guard.GetData());
+    BUSTUB_ASSERT(directory_page != nullptr, "directory page cannot be nullptr");
+    // A torn read may see any global depth, so stay within the directory until the read is validated.
+    bucket_page_id = INVALID_PAGE_ID;
+    if (directory_page->GetGlobalDepth() <= MAX_BUCKET_DEPTH) {
+      bucket_page_id = directory_page->GetBucketPageId(hash & directory_page->GetGlobalDepthMask());
+    }
+  } while (!guard.Validate());
+  return bucket_page_id;
+}
+
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
   table_latch_.RLock();
-  auto directory_page = FetchDirectoryPage();
-  auto bucket_page_id = KeyToPageId(key,directory_page);
+  auto bucket_page_id = ReadBucketPageId(key);
   auto bucket_page = FetchBucketPage(bucket_page_id);
   auto bucket_page_data = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(bucket_page->GetData());
 
@@ -106,8 +123,7 @@ auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
   bucket_page->RUnlatch();
 
   buffer_pool_manager_->UnpinPage(bucket_page_id, false);
-  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
-  
+
 
   table_latch_.RUnlock();
   return success;
@@ -119,9 +135,7 @@ auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
   table_latch_.RLock();
-  auto directory_page = FetchDirectoryPage();
-  // auto bucket_idx = KeyToDirectoryIndex(key, directory_page);
-  auto bucket_page_id = KeyToPageId(key,directory_page);
+  auto bucket_page_id = ReadBucketPageId(key);
   auto bucket_page = FetchBucketPage(bucket_page_id);
   auto bucket_page_data = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(bucket_page->GetData());
   // LOG_DEBUG("Insert():bucket idx: %d,page id: %d", bucket_idx,bucket_page_id);
@@ -129,7 +143,6 @@ auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
   bucket_page->WLatch();
   if(bucket_page_data->IsFull()){
     buffer_pool_manager_->UnpinPage(bucket_page_id, false);
-    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
     bucket_page->WUnlatch();
     table_latch_.RUnlock();
     return SplitInsert(transaction, key, value);
@@ -138,8 +151,7 @@ auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
   bucket_page->WUnlatch();
 
   buffer_pool_manager_->UnpinPage(bucket_page_id, success);
-  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
-  
+
   table_latch_.RUnlock();
   return success;
 }
@@ -147,7 +159,11 @@ auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
   table_latch_.WLock();
-  auto directory_page = FetchDirectoryPage();
+  auto directory_raw_page = buffer_pool_manager_->FetchPageWithPriority(directory_page_id_, PagePriority::HIGH);
+  BUSTUB_ASSERT(directory_raw_page != nullptr, "directory page cannot be nullptr");
+  // Write latch the directory so that optimistic readers of it notice the split.
+  directory_raw_page->WLatch();
+  auto directory_page = reinterpret_cast<HashTableDirectoryPage *>(directory_raw_page->GetData());
   bool success = false;
 
   while (1) {
@@ -216,6 +232,7 @@ auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
       directory_page->SetLocalDepth(i, directory_page->GetLocalDepth(bucket_idx));
     }
   }
+  directory_raw_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(directory_page_id_, true);
 
   table_latch_.WUnlock();
@@ -228,8 +245,7 @@ auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
   table_latch_.RLock();
-  auto directory_page = FetchDirectoryPage();
-  auto bucket_page_id = KeyToPageId(key,directory_page);
+  auto bucket_page_id = ReadBucketPageId(key);
   auto bucket_page = FetchBucketPage(bucket_page_id);
   auto bucket_page_data = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(bucket_page->GetData());
 
@@ -242,7 +258,6 @@ auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const
     Merge(transaction, key, value);
   }
   buffer_pool_manager_->UnpinPage(bucket_page_id, success);
-  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
 
   table_latch_.RUnlock();
   return success;
@@ -253,7 +268,9 @@ auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  auto directory_page = FetchDirectoryPage();
+  auto directory_raw_page = buffer_pool_manager_->FetchPageWithPriority(directory_page_id_, PagePriority::HIGH);
+  BUSTUB_ASSERT(directory_raw_page != nullptr, "directory page cannot be nullptr");
+  auto directory_page = reinterpret_cast<HashTableDirectoryPage *>(directory_raw_page->GetData());
   auto bucket_page_id = KeyToPageId(key,directory_page);
   auto bucket_idx = KeyToDirectoryIndex(key, directory_page);   
   auto image_bucket_index = directory_page->GetSplitImageIndex(bucket_idx);
@@ -261,10 +278,12 @@ void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const
    // local depth为0说明已经最小了，不收缩
   uint32_t local_depth = directory_page->GetLocalDepth(bucket_idx);
   if (local_depth == 0) {
+    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
     return;
   }
 
   if (local_depth != directory_page->GetLocalDepth(image_bucket_index)) {
+    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
     return;
   }
 
@@ -281,6 +300,8 @@ void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const
   buffer_pool_manager_->UnpinPage(bucket_page_id, false);
   buffer_pool_manager_->DeletePage(bucket_page_id);
 
+  // Write latch the directory so that optimistic readers of it notice the merge.
+  directory_raw_page->WLatch();
   auto image_bucket_page_id = directory_page->GetBucketPageId(image_bucket_index);
   directory_page->SetBucketPageId(bucket_idx, image_bucket_page_id);
   directory_page->DecrLocalDepth(bucket_idx);
@@ -296,6 +317,7 @@ void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const
   while (directory_page->CanShrink()) {
     directory_page->DecrGlobalDepth();
   }
+  directory_raw_page->WUnlatch();
 
   buffer_pool_manager_->UnpinPage(directory_page_id_, true);
 }
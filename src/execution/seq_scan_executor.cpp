@@ -24,7 +24,7 @@ SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNod
 
 void SeqScanExecutor::Init() {
     table_info_ =  exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid());
-    iter_ = table_info_->table_->Begin(exec_ctx_->GetTransaction());
+    iter_ = table_info_->table_->Begin(exec_ctx_->GetTransaction(), &strategy_);
 }
 
 auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { 
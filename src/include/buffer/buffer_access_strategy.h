@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * BufferAccessStrategy is the "bulk read" access strategy of a single scan, in the spirit of PostgreSQL's ring
+ * buffers. The scan remembers the last few frames it read pages into. When it misses again, the buffer pool recycles
+ * the oldest of those frames in place if it still holds the page the scan put there and nobody is using it, instead
+ * of taking a victim from the shared replacer. A large scan therefore only ever occupies about ring_size frames and
+ * does not push the rest of the working set out of the pool.
+ *
+ * A strategy is owned by one scan and is not thread-safe.
+ */
+class BufferAccessStrategy {
+  friend class BufferPoolManagerInstance;
+
+ public:
+  /**
+   * Create a new BufferAccessStrategy.
+   * @param ring_size the number of frames the scan may recycle
+   */
+  explicit BufferAccessStrategy(size_t ring_size = SCAN_RING_SIZE) : ring_(ring_size) {
+    BUSTUB_ASSERT(ring_size > 0, "A buffer ring needs at least one frame");
+  }
+
+  DISALLOW_COPY(BufferAccessStrategy);
+
+  /** @return the number of frames in the ring */
+  auto GetRingSize() const -> size_t { return ring_.size(); }
+
+ private:
+  /** A frame the scan has read a page into. The owner identifies the buffer pool instance the frame belongs to. */
+  struct Slot {
+    const void *owner_ = nullptr;
+    frame_id_t frame_id_ = -1;
+    page_id_t page_id_ = INVALID_PAGE_ID;
+  };
+
+  /** @return the i-th oldest slot of the ring */
+  auto SlotAt(size_t i) -> Slot & { return ring_[(current_ + i) % ring_.size()]; }
+
+  /** Point the i-th oldest slot at a new frame and page of the same owner, and make it the newest slot of the ring. */
+  void Renew(size_t i, frame_id_t frame_id, page_id_t page_id) {
+    Slot renewed = SlotAt(i);
+    renewed.frame_id_ = frame_id;
+    renewed.page_id_ = page_id;
+    for (size_t j = i; j + 1 < ring_.size(); ++j) {
+      SlotAt(j) = SlotAt(j + 1);
+    }
+    SlotAt(ring_.size() - 1) = renewed;
+  }
+
+  /** Record a frame that was newly added to the ring, replacing the oldest slot. */
+  void Advance(const void *owner, frame_id_t frame_id, page_id_t page_id) {
+    ring_[current_] = {owner, frame_id, page_id};
+    current_ = (current_ + 1) % ring_.size();
+  }
+
+  std::vector<Slot> ring_;
+  size_t current_ = 0;
+};
+
+}  // namespace bustub
@@ -15,7 +15,10 @@
 #include <list>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_stats.h"
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
@@ -45,6 +48,89 @@ class BufferPoolManager {
     return result;
   }
 
+  /**
+   * Fetch a page on behalf of a bulk reader. On a miss the page is read into a frame recycled from the strategy's
+   * ring when possible, instead of a victim taken from the replacer.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the scan, nullptr for a regular fetch
+   * @param callback the grading callback, like for FetchPage
+   * @return the requested page
+   */
+  auto FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy,
+                             bufferpool_callback_fn callback = nullptr) -> Page * {
+    GradingCallback(callback, CallbackType::BEFORE, page_id);
+    auto *result = FetchPgImp(page_id, strategy);
+    GradingCallback(callback, CallbackType::AFTER, page_id);
+    return result;
+  }
+
+  /**
+   * Fetch a page with a priority hint. Pages fetched with PagePriority::HIGH, like index roots and directories, are
+   * evicted after all other pages, as long as they take up at most HIGH_PRIORITY_PERCENT of the pool. The priority
+   * sticks to the page until it is evicted; fetching it again with PagePriority::NORMAL does not lower it.
+   * @param page_id id of page to be fetched
+   * @param priority the priority of the page
+   * @param callback the grading callback, like for FetchPage
+   * @return the requested page
+   */
+  auto FetchPageWithPriority(page_id_t page_id, PagePriority priority, bufferpool_callback_fn callback = nullptr)
+      -> Page * {
+    GradingCallback(callback, CallbackType::BEFORE, page_id);
+    auto *result = FetchPgImp(page_id, priority);
+    GradingCallback(callback, CallbackType::AFTER, page_id);
+    return result;
+  }
+
+  /**
+   * Fetch a page only if it is already resident and not being read in. Never blocks on disk I/O.
+   * @param page_id id of page to be fetched
+   * @return the pinned page, or nullptr if the page is not ready in the buffer pool
+   */
+  auto FetchResidentPage(page_id_t page_id) -> Page * { return FetchResidentPgImp(page_id); }
+
+  /**
+   * Look up a resident page for an optimistic read, without pinning or latching it. The frame may be modified or
+   * reused for another page at any time; anything read from it must be checked with Page::ValidateVersion.
+   * Most callers should use OptimisticPageGuard instead.
+   * @param page_id id of page to be read
+   * @param[out] version the version of the page to validate the read against
+   * @return the page, or nullptr if it is not resident, being read in or being modified
+   */
+  auto FetchPageOptimistic(page_id_t page_id, uint64_t *version) -> Page * {
+    return FetchPgOptimisticImp(page_id, version);
+  }
+
+  /**
+   * Ask the buffer pool to read a page in the background, so that a later fetch of it does not wait for the disk.
+   * The page is left unpinned once it is loaded. This is only a hint: it may be dropped when the pool is busy.
+   * @param page_id id of page to be read ahead
+   */
+  void PrefetchPage(page_id_t page_id) { PrefetchPgImp(page_id); }
+
+  /**
+   * Fetch several pages at once, e.g. the pages of a batch of RIDs. Implementations may serve all of them with a
+   * single latch acquisition and read the missing pages as one batch. A page id may appear more than once, in which
+   * case the page is pinned once per occurrence.
+   * @param page_ids ids of the pages to be fetched
+   * @param num_pages number of page ids
+   * @param[out] pages the fetched pages, in the order of page_ids; nullptr for pages that could not be fetched
+   * @return true if every page was fetched, false otherwise
+   */
+  auto FetchPages(const page_id_t *page_ids, size_t num_pages, Page **pages) -> bool {
+    return FetchPgsImp(page_ids, num_pages, pages);
+  }
+
+  /**
+   * Unpin several pages at once, the counterpart of FetchPages.
+   * @param page_ids ids of the pages to be unpinned
+   * @param num_pages number of page ids
+   * @param is_dirty true if the pages should be marked as dirty, false otherwise
+   * @return false if the pin count of any page was <= 0 before this call, true otherwise
+   */
+  auto UnpinPages(const page_id_t *page_ids, size_t num_pages, bool is_dirty) -> bool {
+    return UnpinPgsImp(page_ids, num_pages, is_dirty);
+  }
+
   /** Grading function. Do not modify! */
   auto UnpinPage(page_id_t page_id, bool is_dirty, bufferpool_callback_fn callback = nullptr) -> bool {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -69,6 +155,21 @@ class BufferPoolManager {
     return result;
   }
 
+  /**
+   * Create a new page with a priority hint, see FetchPageWithPriority.
+   * @param[out] page_id id of created page
+   * @param priority the priority of the page
+   * @param callback the grading callback, like for NewPage
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPageWithPriority(page_id_t *page_id, PagePriority priority, bufferpool_callback_fn callback = nullptr)
+      -> Page * {
+    GradingCallback(callback, CallbackType::BEFORE, INVALID_PAGE_ID);
+    auto *result = NewPgImp(page_id, priority);
+    GradingCallback(callback, CallbackType::AFTER, *page_id);
+    return result;
+  }
+
   /** Grading function. Do not modify! */
   auto DeletePage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) -> bool {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -87,6 +188,35 @@ class BufferPoolManager {
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
+  /**
+   * Grow or shrink the buffer pool while it is in use. Shrinking evicts the pages of the frames given up, writing
+   * back dirty ones, and waits for pinned ones to be unpinned before it returns their memory; the caller must
+   * therefore not hold pins itself. If a page stays pinned for longer than RESIZE_TIMEOUT, shrinking gives up.
+   * @param pool_size the new number of frames
+   * @return false if the buffer pool cannot take that size or gave up waiting, true otherwise
+   */
+  auto Resize(size_t pool_size) -> bool { return ResizeImp(pool_size); }
+
+  /**
+   * Take a snapshot of the resident pages, e.g. to load them again after a restart.
+   * @return the ids of the resident pages, most recently used first
+   */
+  auto GetResidentPages() -> std::vector<page_id_t> {
+    std::vector<page_id_t> page_ids;
+    GetResidentPgsImp(&page_ids);
+    return page_ids;
+  }
+
+  /**
+   * Take a snapshot of the statistics of the buffer pool, e.g. to print it with BufferPoolStats::ToString().
+   * @return the statistics, summed over all instances
+   */
+  auto GetStats() -> BufferPoolStats {
+    BufferPoolStats stats;
+    GetStatsImp(&stats);
+    return stats;
+  }
+
  protected:
   /**
    * Grading function. Do not modify!
@@ -108,6 +238,94 @@ class BufferPoolManager {
    */
   virtual auto FetchPgImp(page_id_t page_id) -> Page * = 0;
 
+  /**
+   * Fetch the requested page from the buffer pool using an access strategy.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the caller, may be nullptr
+   * @return the requested page
+   */
+  virtual auto FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * { return FetchPgImp(page_id); }
+
+  /**
+   * Fetch the requested page from the buffer pool with a priority hint. The default ignores the hint.
+   * @param page_id id of page to be fetched
+   * @param priority the priority of the page
+   * @return the requested page
+   */
+  virtual auto FetchPgImp(page_id_t page_id, PagePriority priority) -> Page * { return FetchPgImp(page_id); }
+
+  /**
+   * Fetch a batch of pages. The default fetches them one at a time.
+   * @param page_ids ids of the pages to be fetched
+   * @param num_pages number of page ids
+   * @param[out] pages the fetched pages, nullptr for pages that could not be fetched
+   * @return true if every page was fetched, false otherwise
+   */
+  virtual auto FetchPgsImp(const page_id_t *page_ids, size_t num_pages, Page **pages) -> bool {
+    bool fetched_all = true;
+    for (size_t i = 0; i < num_pages; ++i) {
+      pages[i] = FetchPgImp(page_ids[i]);
+      fetched_all = fetched_all && pages[i] != nullptr;
+    }
+    return fetched_all;
+  }
+
+  /**
+   * Unpin a batch of pages. The default unpins them one at a time.
+   * @param page_ids ids of the pages to be unpinned
+   * @param num_pages number of page ids
+   * @param is_dirty true if the pages should be marked as dirty, false otherwise
+   * @return false if the pin count of any page was <= 0 before this call, true otherwise
+   */
+  virtual auto UnpinPgsImp(const page_id_t *page_ids, size_t num_pages, bool is_dirty) -> bool {
+    bool unpinned_all = true;
+    for (size_t i = 0; i < num_pages; ++i) {
+      unpinned_all = UnpinPgImp(page_ids[i], is_dirty) && unpinned_all;
+    }
+    return unpinned_all;
+  }
+
+  /**
+   * Fetch the requested page if it is resident and no disk I/O is in flight on it.
+   * @param page_id id of page to be fetched
+   * @return the requested page, or nullptr if it is not ready
+   */
+  virtual auto FetchResidentPgImp(page_id_t page_id) -> Page * { return nullptr; }
+
+  /**
+   * Look up a resident page for an optimistic read. The default does not support optimistic reads.
+   * @param page_id id of page to be read
+   * @param[out] version the version of the page to validate the read against
+   * @return the page, or nullptr if it cannot be read optimistically
+   */
+  virtual auto FetchPgOptimisticImp(page_id_t page_id, uint64_t *version) -> Page * { return nullptr; }
+
+  /**
+   * Schedule an asynchronous read of the page. Buffer pools without a read-ahead worker ignore the hint.
+   * @param page_id id of page to be read ahead
+   */
+  virtual void PrefetchPgImp(page_id_t page_id) {}
+
+  /**
+   * Change the number of frames of the buffer pool. Buffer pools of a fixed size refuse.
+   * @param pool_size the new number of frames
+   * @return false if the buffer pool cannot take that size, true otherwise
+   */
+  virtual auto ResizeImp(size_t pool_size) -> bool { return false; }
+
+  /**
+   * Append the ids of the resident pages to a list, most recently used first. Buffer pools that cannot tell add
+   * nothing.
+   * @param[out] page_ids the list to append to
+   */
+  virtual void GetResidentPgsImp(std::vector<page_id_t> *page_ids) {}
+
+  /**
+   * Add the statistics of the buffer pool to a snapshot. Buffer pools without statistics add nothing.
+   * @param[out] stats the snapshot
+   */
+  virtual void GetStatsImp(BufferPoolStats *stats) {}
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -130,6 +348,14 @@ class BufferPoolManager {
    */
   virtual auto NewPgImp(page_id_t *page_id) -> Page * = 0;
 
+  /**
+   * Creates a new page in the buffer pool with a priority hint. The default ignores the hint.
+   * @param[out] page_id id of created page
+   * @param priority the priority of the page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual auto NewPgImp(page_id_t *page_id, PagePriority priority) -> Page * { return NewPgImp(page_id); }
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
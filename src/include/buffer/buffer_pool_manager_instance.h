@@ -12,30 +12,43 @@
 
 #pragma once
 
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
-#include <mutex>  // NOLINT
-#include <unordered_map>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
-#include "buffer/lru_replacer.h"
+#include "buffer/compressed_page_cache.h"
+#include "buffer/frame_arena.h"
+#include "buffer/page_table.h"
+#include "buffer/replacer.h"
+#include "common/util/numa_util.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/free_page_map.h"
 #include "storage/page/page.h"
 
 namespace bustub {
 
 /**
- * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ * BufferPoolManager reads disk pages to and from its internal buffer pool. It is attached to its disk manager, which
+ * detaches it before shutting down, so that the pool and the disk manager can be torn down in either order.
  */
-class BufferPoolManagerInstance : public BufferPoolManager {
+class BufferPoolManagerInstance : public BufferPoolManager, public DiskManagerClient {
  public:
   /**
    * Creates a new BufferPoolManagerInstance.
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_policy the replacement policy used to pick victim frames
+   * @param max_pool_size the size the buffer pool may grow to, 0 for pool_size
    */
-  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerPolicy replacer_policy = ReplacerPolicy::LRU, size_t max_pool_size = 0);
   /**
    * Creates a new BufferPoolManagerInstance.
    * @param pool_size the size of the buffer pool
@@ -43,21 +56,71 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param instance_index index of this BPI in the parallel BPM
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_policy the replacement policy used to pick victim frames
+   * @param max_pool_size the size the buffer pool may grow to, 0 for pool_size
    */
   BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                            DiskManager *disk_manager, LogManager *log_manager = nullptr);
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerPolicy replacer_policy = ReplacerPolicy::LRU, size_t max_pool_size = 0);
 
   /**
-   * Destroys an existing BufferPoolManagerInstance.
+   * Destroys an existing BufferPoolManagerInstance, writing back its dirty pages unless the disk manager detached it.
    */
   ~BufferPoolManagerInstance() override;
 
+  /**
+   * Write back every dirty page, stop the page cleaner and the read-ahead worker, and unregister the frames from the
+   * disk manager. Called by the disk manager before it shuts down or is destroyed, or by the destructor.
+   */
+  void DetachDiskManager() override;
+
   /** @return size of the buffer pool */
   auto GetPoolSize() -> size_t override { return pool_size_; }
 
-  /** @return pointer to all the pages in the buffer pool */
+  /** @return the size the buffer pool may grow to */
+  auto GetMaxPoolSize() const -> size_t { return max_pool_size_; }
+
+  /** @return pointer to all the pages in the buffer pool, GetMaxPoolSize() of them */
   auto GetPages() -> Page * { return pages_; }
 
+  /** @return the NUMA node the frames of this instance are placed on */
+  auto GetNumaNode() const -> uint32_t { return numa_node_; }
+
+  /** A page handed out for writing by BeginFlush: its id and its data. */
+  using DirtyPage = std::pair<page_id_t, const char *>;
+
+  /**
+   * Start flushing all pages: take a snapshot of the dirty frames, marking them clean and io_in_progress_, which
+   * keeps them from being evicted and lock-free fetches of them from succeeding until EndFlush. Frames already being
+   * written back are left out; they are flushed with FlushPage once the writes are done.
+   * @param[out] dirty_pages the list to append the dirty pages to
+   * @param[out] busy_pages the list to append the pages left out to
+   */
+  void BeginFlush(std::vector<DirtyPage> *dirty_pages, std::vector<page_id_t> *busy_pages);
+
+  /**
+   * Finish flushing the pages that BeginFlush handed out after they were written.
+   * @param dirty_pages written pages; pages of other instances are ignored
+   * @param failed_pages ids of the pages that could not be written, sorted; they are marked dirty again
+   */
+  void EndFlush(const std::vector<DirtyPage> &dirty_pages, const std::vector<page_id_t> &failed_pages);
+
+  /** Write the pages deallocated since the last flush to the free page map on disk. */
+  void FlushFreePageMap() { free_page_map_.Flush(); }
+
+  /** @return the number of deallocated pages waiting to be reused */
+  auto GetNumFreePages() -> size_t { return free_page_map_.GetNumFreePages(); }
+
+  /**
+   * Write pages sorted by page id, merging consecutive pages into one write of at most FLUSH_MAX_RUN pages.
+   * @param disk_manager the disk manager to write with
+   * @param dirty_pages the pages, sorted by page id
+   * @param num_pages the number of pages
+   * @return the ids of the pages that could not be written, sorted
+   */
+  static auto WriteSortedPages(DiskManager *disk_manager, const DirtyPage *dirty_pages, size_t num_pages)
+      -> std::vector<page_id_t>;
+
  protected:
   /**
    * Fetch the requested page from the buffer pool.
@@ -66,6 +129,64 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto FetchPgImp(page_id_t page_id) -> Page * override;
 
+  /**
+   * Fetch the requested page from the buffer pool. On a miss, the next frame of the strategy's ring is recycled if
+   * it still holds the page the strategy read into it, is unpinned and clean.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the caller, may be nullptr
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override;
+
+  /**
+   * Fetch the requested page from the buffer pool and hand its priority to the replacer.
+   * @param page_id id of page to be fetched
+   * @param priority the priority of the page
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id, PagePriority priority) -> Page * override;
+
+  /**
+   * Look up a resident page for an optimistic read, without pinning or latching it.
+   * @param page_id id of page to be read
+   * @param[out] version the version of the page to validate the read against
+   * @return the page, or nullptr if it is not resident, being read in or being modified
+   */
+  auto FetchPgOptimisticImp(page_id_t page_id, uint64_t *version) -> Page * override;
+
+  /**
+   * Fetch the requested page if it is resident and no disk I/O is in flight on it.
+   * @param page_id id of page to be fetched
+   * @return the requested page, or nullptr if it is not ready
+   */
+  auto FetchResidentPgImp(page_id_t page_id) -> Page * override;
+
+  /**
+   * Queue the page for the read-ahead worker. Requests for resident pages, and requests arriving while
+   * PREFETCH_QUEUE_SIZE reads are already pending, are dropped.
+   * @param page_id id of page to be read ahead
+   */
+  void PrefetchPgImp(page_id_t page_id) override;
+
+  /**
+   * Fetch a batch of pages with a single latch acquisition. Hits are pinned right away; the frames for all misses are
+   * set up first and the missing pages are then read in page id order with the latch released once.
+   * @param page_ids ids of the pages to be fetched
+   * @param num_pages number of page ids
+   * @param[out] pages the fetched pages, nullptr for pages that could not be fetched
+   * @return true if every page was fetched, false otherwise
+   */
+  auto FetchPgsImp(const page_id_t *page_ids, size_t num_pages, Page **pages) -> bool override;
+
+  /**
+   * Unpin a batch of pages.
+   * @param page_ids ids of the pages to be unpinned
+   * @param num_pages number of page ids
+   * @param is_dirty true if the pages should be marked as dirty, false otherwise
+   * @return false if the pin count of any page was <= 0 before this call, true otherwise
+   */
+  auto UnpinPgsImp(const page_id_t *page_ids, size_t num_pages, bool is_dirty) -> bool override;
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -81,6 +202,30 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto FlushPgImp(page_id_t page_id) -> bool override;
 
+  /**
+   * Grow or shrink the buffer pool within the frames reserved for it. Growing hands the added frames to the free
+   * list. Shrinking stops handing out the frames beyond the new size, evicts their pages once they are unpinned, with
+   * the latch released while waiting and while writing back dirty pages, and then returns their memory. If a page
+   * stays pinned for RESIZE_TIMEOUT, the pool goes back to its old size, with the frames evicted so far free again.
+   * @param pool_size the new number of frames, between 1 and GetMaxPoolSize()
+   * @return false if pool_size is out of range or a page stayed pinned, true otherwise
+   */
+  auto ResizeImp(size_t pool_size) -> bool override;
+
+  /**
+   * Append the ids of the resident pages, most recently used first: pinned pages, then the evictable ones in the
+   * reverse of the replacer's eviction order, then pages the replacer does not rank.
+   * @param[out] page_ids the list to append to
+   */
+  void GetResidentPgsImp(std::vector<page_id_t> *page_ids) override;
+
+  /**
+   * Add the counters of this instance, the length of its free list and its pinned frame high-water mark to a
+   * snapshot.
+   * @param[out] stats the snapshot
+   */
+  void GetStatsImp(BufferPoolStats *stats) override;
+
   /**
    * Creates a new page in the buffer pool.
    * @param[out] page_id id of created page
@@ -88,6 +233,14 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto NewPgImp(page_id_t *page_id) -> Page * override;
 
+  /**
+   * Creates a new page in the buffer pool and hands its priority to the replacer.
+   * @param[out] page_id id of created page
+   * @param priority the priority of the page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPgImp(page_id_t *page_id, PagePriority priority) -> Page * override;
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
@@ -96,23 +249,156 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   auto DeletePgImp(page_id_t page_id) -> bool override;
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the pages in the buffer pool to disk, in page id order, with consecutive pages merged into one write.
    */
   void FlushAllPgsImp() override;
 
   /**
-   * Allocate a page on disk.∂
+   * Allocate a page on disk, reusing a deallocated one if there is any.
+   * @param[out] reused true if the page was deallocated before, so that the disk may still hold its old content
    * @return the id of the allocated page
    */
-  auto AllocatePage() -> page_id_t;
+  auto AllocatePage(bool *reused) -> page_id_t;
 
   /**
-   * Deallocate a page on disk.
+   * Deallocate a page on disk, so that its space is reused.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(page_id_t page_id) { free_page_map_.Free(page_id); }
+
+  /**
+   * Pin a frame found by a lock-free page table lookup. The pin is only kept if the frame still holds the page and
+   * the page is ready to be used without the latch.
+   * @param frame_id id of the frame
+   * @param page_id id of the page the frame is expected to hold
+   * @return true if the page was pinned, false if the caller has to take the latched path
+   */
+  auto TryPin(frame_id_t frame_id, page_id_t page_id) -> bool;
+
+  /**
+   * Drop one pin of a frame. Does not require the latch.
+   * @param frame_id id of the frame to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the pin count is <= 0 before this call, true otherwise
+   */
+  auto ReleasePin(frame_id_t frame_id, bool is_dirty) -> bool;
+
+  /** Count a frame going from unpinned to pinned, raising the high-water mark if needed. */
+  void CountPinnedFrame();
+
+  /**
+   * Acquire the instance latch, adding the time spent waiting for it to the statistics. An uncontended latch is
+   * taken without reading the clock.
+   * @return the held latch
+   */
+  auto AcquireLatch() -> std::unique_lock<std::mutex>;
+
+  /**
+   * Re-acquire the instance latch after it was released, like AcquireLatch().
+   * @param lock the released instance latch
+   */
+  void ReacquireLatch(std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Claim an unpinned frame for eviction by moving its pin count from 0 to -1, which keeps lock-free fetches from
+   * pinning it. Requires the latch.
+   * @param frame_id id of the frame
+   * @return false if the frame is pinned or already free, true otherwise
+   */
+  auto TryClaimFrame(frame_id_t frame_id) -> bool;
+
+  /**
+   * Put a frame on the free list, unless a shrinking of the buffer pool has given it up. Requires the latch.
+   * @param frame_id id of the free frame
+   */
+  void ReturnFreeFrame(frame_id_t frame_id);
+
+  /**
+   * Find a frame that can hold a new page, taking it from the free list or evicting a victim from the replacer.
+   * A dirty victim is written back, and a victim is added to the compressed page cache, with the latch released, so
+   * the latch may be dropped and re-acquired.
+   * On success the frame is claimed (pin count -1), clean and no longer present in the page table.
+   * @param lock the held instance latch
+   * @param[out] frame_id id of the acquired frame
+   * @return false if every frame is pinned, true otherwise
+   */
+  auto AcquireFrame(std::unique_lock<std::mutex> *lock, frame_id_t *frame_id) -> bool;
+
+  /**
+   * Hand a claimed victim back to the replacer if its page was read optimistically since it was last picked, as if
+   * the page had been pinned for that read. Requires the latch.
+   * @param frame_id id of the claimed frame
+   * @return true if the frame was handed back, false if it may be evicted
+   */
+  auto GiveSecondChance(frame_id_t frame_id) -> bool;
+
+  /**
+   * Take the oldest recyclable frame of this instance out of a strategy's ring so that a new page can be read into
+   * it. The ring slot is updated to point at the new page. Requires the latch.
+   * @param strategy the access strategy of the caller
+   * @param page_id id of the page that will be read into the frame
+   * @param[out] frame_id id of the recycled frame
+   * @return false if no ring frame can be recycled, true otherwise
+   */
+  auto RecycleRingFrame(BufferAccessStrategy *strategy, page_id_t page_id, frame_id_t *frame_id) -> bool;
+
+  /**
+   * Block until the frame has no disk I/O in flight. The latch is released while waiting.
+   * @param lock the held instance latch
+   * @param frame_id id of the frame to wait for
+   */
+  void WaitForIo(std::unique_lock<std::mutex> *lock, frame_id_t frame_id);
+
+  /**
+   * Clear the I/O in progress state of a frame and wake up the threads waiting on it. Requires the latch.
+   * @param frame_id id of the frame whose I/O completed
+   */
+  void FinishIo(frame_id_t frame_id);
+
+  /**
+   * Body of the background page cleaner. Every PAGE_CLEANER_INTERVAL, or when the free list runs low, it writes back
+   * a batch of unpinned dirty frames and moves clean victims onto the free list.
+   */
+  void RunPageCleaner();
+
+  /**
+   * Write back up to PAGE_CLEANER_BATCH_SIZE unpinned dirty frames in page id order. The latch is released during
+   * the writes. Pages whose LSN is not yet persistent in the log are skipped while logging is enabled.
+   * @param lock the held instance latch
+   */
+  void CleanDirtyFrames(std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Move clean victims from the replacer to the free list until it holds the cleaner's target. The latch is released
+   * while the victims are added to the compressed page cache.
+   * @param lock the held instance latch
+   */
+  void RefillFreeList(std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Read a page into a frame, from the compressed page cache if it holds the page, from disk otherwise. Must be
+   * called without the latch, on a frame marked io_in_progress_.
+   * @param page_id id of the page
+   * @param data the frame's data
+   * @param io_class the class the disk read is scheduled as
+   */
+  void ReadPageData(page_id_t page_id, char *data, IoClass io_class);
+
+  /**
+   * Read pages into frames like ReadPageData, merging consecutive pages that are read from disk into one read of at
+   * most FLUSH_MAX_RUN pages.
+   * @param frames the frames, sorted by the id of the page they hold
+   */
+  void ReadSortedPages(const std::vector<frame_id_t> &frames);
+
+  /**
+   * Body of the read-ahead worker. It reads the queued pages into unpinned frames, which become evictable once the
+   * read completes. A fetch of a page being read ahead pins the frame and waits for the read like any other reader.
+   */
+  void RunPrefetcher();
+
+  /** @return the number of free frames the page cleaner tries to maintain */
+  auto FreeFrameTarget() const -> size_t;
 
   /**
    * Validate that the page_id being used is accessible to this BPI. This can be used in all of the functions to
@@ -121,28 +407,70 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   void ValidatePageId(page_id_t page_id) const;
 
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
+  /** Number of frames reserved for the buffer pool, the size it may grow to. */
+  const size_t max_pool_size_;
+  /** Number of pages in the buffer pool. Frames at or beyond it are not handed out. */
+  std::atomic<size_t> pool_size_;
   /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
   const uint32_t num_instances_ = 1;
   /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
   const uint32_t instance_index_ = 0;
-  /** Each BPI maintains its own counter for page_ids to hand out, must ensure they mod back to its instance_index_ */
-  std::atomic<page_id_t> next_page_id_ = instance_index_;
+  /** NUMA node holding the frames of this BPI; instances are spread over the nodes by their index */
+  const uint32_t numa_node_ = 0;
+  /** Each BPI hands out and reclaims its own page_ids, which must mod back to its instance_index_ */
+  FreePageMap free_page_map_;
 
   /** Array of buffer pool pages. */
   Page *pages_;
+  /** Memory holding the data of the buffer pool pages. */
+  FrameArena *frame_arena_;
+  /** True if the frame arena is registered with the disk manager for asynchronous I/O, which pins its memory. */
+  bool frames_registered_ = false;
+  /** One condition variable per frame, signalled when the frame's disk I/O completes. */
+  std::condition_variable *io_cv_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  /** Page table for keeping track of buffer pool pages. Lookups are lock-free, changes require the latch. */
+  PageTable page_table_;
+  /** Compressed copies of evicted clean pages, nullptr if compressed_page_cache_size was 0 on construction. */
+  CompressedPageCache *compressed_cache_ = nullptr;
   /** Replacer to find unpinned pages for replacement. */
   Replacer *replacer_;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * This latch serializes changes to the page table, the free list and the identity of every frame. Resident pages
+   * are pinned and unpinned without it, through atomic updates of their pin count. It is never held across disk
+   * I/O: frames being read or written are marked io_in_progress_ instead.
+   */
   std::mutex latch_;
+  /** Signalled to wake up the page cleaner early. */
+  std::condition_variable cleaner_cv_;
+  /** Set under the latch to stop the background threads. */
+  bool shutdown_ = false;
+  /** True once DetachDiskManager() ran; the background threads are stopped and the frames unregistered. */
+  bool detached_ = false;
+  /** Background thread writing back dirty frames. */
+  std::thread *cleaner_thread_;
+  /** Pages waiting to be read ahead, protected by the latch. */
+  std::deque<page_id_t> prefetch_queue_;
+  /** Signalled when a page is queued for read-ahead. */
+  std::condition_variable prefetch_cv_;
+  /** Background thread serving read-ahead requests. */
+  std::thread *prefetch_thread_;
+  /** Serializes resizes of the buffer pool. */
+  std::mutex resize_latch_;
+  /** True while a shrinking of the pool may wait for pages to be unpinned; set under the latch. */
+  std::atomic<bool> resize_waiting_{false};
+  /** Signalled under the latch when a page is unpinned for the last time while resize_waiting_ is set. */
+  std::condition_variable unpin_cv_;
+  /** Statistics counters, updated without the latch. */
+  BufferPoolCounters stats_;
+  /** Number of frames currently pinned. */
+  std::atomic<size_t> pinned_frames_{0};
+  /** Most frames pinned at the same time so far. */
+  std::atomic<size_t> pinned_high_water_{0};
 };
 }  // namespace bustub
@@ -0,0 +1,153 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * BufferPoolStats is a snapshot of the statistics of a buffer pool. The snapshot of a parallel buffer pool is the
+ * sum over its instances.
+ */
+struct BufferPoolStats {
+  /** Number of buckets of the miss latency histogram. */
+  static constexpr size_t NUM_LATENCY_BUCKETS = 32;
+
+  /** Fetches served from a resident page. */
+  uint64_t hits_ = 0;
+  /** Fetches that had to read the page from disk. */
+  uint64_t misses_ = 0;
+  /** Victims that could be reused right away. */
+  uint64_t clean_evictions_ = 0;
+  /** Victims that had to be written back first. */
+  uint64_t dirty_evictions_ = 0;
+  /** Pages written to disk, by eviction, flushes and the page cleaner. */
+  uint64_t write_backs_ = 0;
+  /** Time threads spent waiting for the instance latch, in nanoseconds. */
+  uint64_t latch_wait_ns_ = 0;
+  /** Frames on the free list when the snapshot was taken. */
+  uint64_t free_frames_ = 0;
+  /** Most frames pinned at the same time; summed over the instances, so an upper bound for a parallel pool. */
+  uint64_t pinned_high_water_ = 0;
+  /**
+   * Service time of fetch misses, from finding the page missing to having it read in. Bucket i counts the misses
+   * that took less than 2^i microseconds, and at least 2^(i-1) microseconds for i > 0.
+   */
+  std::array<uint64_t, NUM_LATENCY_BUCKETS> miss_latency_{};
+
+  /** Misses served by the compressed page cache instead of the disk. */
+  uint64_t compressed_cache_hits_ = 0;
+  /** Misses the compressed page cache could not serve. */
+  uint64_t compressed_cache_misses_ = 0;
+  /** Evicted pages added to the compressed page cache. */
+  uint64_t compressed_cache_insertions_ = 0;
+  /** Evicted pages that did not compress well enough to be cached. */
+  uint64_t compressed_cache_rejections_ = 0;
+  /** Pages dropped from the compressed page cache to stay within its budget. */
+  uint64_t compressed_cache_evictions_ = 0;
+  /** Pages in the compressed page cache when the snapshot was taken. */
+  uint64_t compressed_cache_pages_ = 0;
+  /** Bytes of compressed data in the compressed page cache when the snapshot was taken. */
+  uint64_t compressed_cache_bytes_ = 0;
+
+  /**
+   * Add the statistics of another buffer pool to this one.
+   * @param other the statistics to add
+   */
+  void Merge(const BufferPoolStats &other);
+
+  /** @return the fraction of fetches that were hits, 0 if there was no fetch */
+  auto HitRatio() const -> double;
+
+  /**
+   * @param percentile the percentile, between 0 and 100
+   * @return an upper bound of the miss service time at that percentile in microseconds, 0 if there was no miss
+   */
+  auto MissLatencyPercentile(double percentile) const -> uint64_t;
+
+  /** @return the statistics in a human readable form */
+  auto ToString() const -> std::string;
+
+  /**
+   * @param latency_us a miss service time in microseconds
+   * @return the histogram bucket counting it
+   */
+  static auto LatencyBucket(uint64_t latency_us) -> size_t;
+};
+
+/** The counters of a buffer pool instance. */
+enum class BufferPoolCounter { HITS = 0, MISSES, CLEAN_EVICTIONS, DIRTY_EVICTIONS, WRITE_BACKS, LATCH_WAIT_NS };
+
+/**
+ * BufferPoolCounters keeps the counters of a buffer pool instance. They are always on, so they are striped over
+ * cache line sized slots: every thread updates the slot it was assigned with relaxed atomics, which it shares with
+ * no other thread as long as there are at most NUM_STRIPES of them. Collect() sums the slots, so a snapshot taken
+ * while the buffer pool is in use is not exact.
+ */
+class BufferPoolCounters {
+ public:
+  BufferPoolCounters() = default;
+
+  DISALLOW_COPY_AND_MOVE(BufferPoolCounters);
+
+  /**
+   * Add to a counter.
+   * @param counter the counter
+   * @param value the amount to add
+   */
+  void Add(BufferPoolCounter counter, uint64_t value = 1) {
+    LocalStripe()->counters_[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+  }
+
+  /**
+   * Count a fetch miss in the latency histogram.
+   * @param latency_us the service time of the miss in microseconds
+   */
+  void RecordMissLatency(uint64_t latency_us) {
+    LocalStripe()->miss_latency_[BufferPoolStats::LatencyBucket(latency_us)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * Add the counters to a snapshot.
+   * @param[out] stats the snapshot
+   */
+  void Collect(BufferPoolStats *stats) const;
+
+ private:
+  /** Number of slots; threads beyond that share them. */
+  static constexpr size_t NUM_STRIPES = 16;
+  static constexpr size_t NUM_COUNTERS = static_cast<size_t>(BufferPoolCounter::LATCH_WAIT_NS) + 1;
+
+  struct alignas(CACHE_LINE_SIZE) Stripe {
+    std::array<std::atomic<uint64_t>, NUM_COUNTERS> counters_{};
+    std::array<std::atomic<uint64_t>, BufferPoolStats::NUM_LATENCY_BUCKETS> miss_latency_{};
+  };
+
+  /** @return the slot of the calling thread */
+  auto LocalStripe() -> Stripe * {
+    static std::atomic<size_t> next_thread_slot{0};
+    thread_local size_t thread_slot = next_thread_slot++;
+    return &stripes_[thread_slot % NUM_STRIPES];
+  }
+
+  std::array<Stripe, NUM_STRIPES> stripes_;
+};
+
+}  // namespace bustub
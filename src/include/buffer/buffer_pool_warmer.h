@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_warmer.h
+//
+// Identification: src/include/buffer/buffer_pool_warmer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * BufferPoolWarmer keeps the resident page set of a buffer pool across restarts. It saves the ids of the resident
+ * pages with their recency rank to a small side file, and on startup fetches the saved pages back in page id order,
+ * so that the pool does not have to warm up again from cold misses.
+ *
+ * The side file holds a header followed by (page id, rank) entries sorted by page id; rank 0 is the most recently
+ * used page. It is written to a temporary file first and renamed, so a crash never leaves a torn file behind.
+ */
+class BufferPoolWarmer {
+ public:
+  /**
+   * Create a new BufferPoolWarmer.
+   * @param buffer_pool_manager the buffer pool to warm up
+   * @param file_name the side file holding the resident pages
+   */
+  BufferPoolWarmer(BufferPoolManager *buffer_pool_manager, std::string file_name)
+      : buffer_pool_manager_(buffer_pool_manager), file_name_(std::move(file_name)) {}
+
+  /** Stops the background thread, saving the resident pages one last time if it was running. */
+  ~BufferPoolWarmer();
+
+  DISALLOW_COPY(BufferPoolWarmer);
+
+  /**
+   * Start the background thread. It loads the saved pages while the buffer pool already serves requests, then saves
+   * the resident pages every warmup_save_interval.
+   */
+  void RunWarmupThread();
+
+  /** Stop the background thread and save the resident pages, e.g. on a clean shutdown. */
+  void StopWarmupThread();
+
+  /**
+   * Save the resident pages of the buffer pool to the side file.
+   * @return false if the file could not be written, true otherwise
+   */
+  auto Save() -> bool;
+
+  /**
+   * Fetch the pages saved in the side file into the buffer pool, at most as many as the pool holds, preferring the
+   * most recently used ones. The pages are fetched in page id order, WARMUP_BATCH_SIZE at a time, and left unpinned.
+   * @return the number of pages loaded
+   */
+  auto Load() -> size_t;
+
+ private:
+  /** Identifies a side file, and its layout version. */
+  static constexpr uint32_t MAGIC = 0x42575531;
+
+  /** Body of the background thread. */
+  void RunWarmup();
+
+  BufferPoolManager *buffer_pool_manager_;
+  const std::string file_name_;
+  /** Background thread loading and saving the resident pages. */
+  std::thread *warmup_thread_ = nullptr;
+  /** Set to stop the background thread. */
+  bool stop_ = false;
+  std::mutex latch_;
+  std::condition_variable cv_;
+};
+
+}  // namespace bustub
@@ -12,8 +12,7 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
+#include <atomic>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -23,6 +22,10 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * The replacer is lock-free. Every frame has an atomic "in replacer" flag and an atomic reference bit, so Pin and
+ * Unpin are a single atomic exchange, plus the update of the count of frames. Only Victim advances the clock hand, giving each referenced frame a second
+ * chance before evicting it.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -45,8 +48,19 @@ class ClockReplacer : public Replacer {
 
   auto Size() -> size_t override;
 
+  auto EvictionOrder() -> std::vector<frame_id_t> override;
+
  private:
-  // TODO(student): implement me!
+  /** Number of frames tracked by the replacer. */
+  const size_t num_pages_;
+  /** True if the frame is unpinned and may be victimized. */
+  std::vector<std::atomic<bool>> in_replacer_;
+  /** The reference bit, set on unpin and cleared when the hand sweeps past the frame. */
+  std::vector<std::atomic<bool>> ref_;
+  /** Position of the clock hand; reduced modulo num_pages_ when used. */
+  std::atomic<size_t> hand_{0};
+  /** Number of frames that may be victimized, raised before a frame's flag is set and lowered after it is cleared. */
+  std::atomic<size_t> size_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.h
+//
+// Identification: src/include/buffer/compressed_page_cache.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
+#include "buffer/buffer_pool_stats.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * CompressedPageCache is a second tier below a buffer pool instance. It keeps compressed copies of clean pages the
+ * instance evicted, so that fetching them again costs a decompression instead of a disk read. The cache is
+ * exclusive: a page leaves it when it is read back into the buffer pool, and enters it again on its next eviction.
+ * Since only clean pages are cached, and a page can only be modified while it is in the buffer pool, a cached copy
+ * always matches the disk.
+ *
+ * The compressed data of all entries is kept within a memory budget, evicting the least recently inserted entries
+ * first. Pages that do not compress to at most MAX_COMPRESSED_SIZE bytes are not worth their memory and are not
+ * cached. The cache has its own latch; callers need no other synchronization.
+ */
+class CompressedPageCache {
+ public:
+  /**
+   * Create a new CompressedPageCache.
+   * @param capacity the number of bytes the compressed pages may take up
+   */
+  explicit CompressedPageCache(size_t capacity) : capacity_(capacity) {}
+
+  DISALLOW_COPY_AND_MOVE(CompressedPageCache);
+
+  /**
+   * Keep a compressed copy of an evicted clean page, replacing any older copy.
+   * @param page_id id of the page
+   * @param data the PAGE_SIZE bytes of the page
+   */
+  void Insert(page_id_t page_id, const char *data);
+
+  /**
+   * Read a page back from the cache. The page leaves the cache.
+   * @param page_id id of the page
+   * @param[out] data the PAGE_SIZE bytes receiving the page
+   * @return true if the page was cached, false if it has to be read from disk
+   */
+  auto Lookup(page_id_t page_id, char *data) -> bool;
+
+  /**
+   * Drop the copy of a page, e.g. when the page is deleted.
+   * @param page_id id of the page
+   */
+  void Erase(page_id_t page_id);
+
+  /** @return the number of bytes the compressed pages take up */
+  auto GetSize() -> size_t;
+
+  /**
+   * Add the statistics of the cache to a snapshot.
+   * @param[out] stats the snapshot
+   */
+  void Collect(BufferPoolStats *stats);
+
+  /** Compressed pages larger than this are not cached. */
+  static constexpr size_t MAX_COMPRESSED_SIZE = PAGE_SIZE / 4 * 3;
+
+ private:
+  struct Entry {
+    page_id_t page_id_;
+    std::string data_;
+  };
+
+  /** Remove an entry. Requires the latch. */
+  void Remove(std::list<Entry>::iterator it);
+
+  const size_t capacity_;
+  /** Bytes of compressed data held, protected by the latch. */
+  size_t size_ = 0;
+  /** Entries, most recently inserted first. */
+  std::list<Entry> entries_;
+  std::unordered_map<page_id_t, std::list<Entry>::iterator> index_;
+  std::mutex latch_;
+
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> insertions_{0};
+  std::atomic<uint64_t> rejections_{0};
+  std::atomic<uint64_t> evictions_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena is the memory holding the page data of a buffer pool instance: one mapping, aligned to HUGE_PAGE_SIZE,
+ * with the frames laid out back to back. It is backed by explicit huge pages if the system has them reserved, and
+ * otherwise advised for transparent huge pages, so that the whole pool is covered by few TLB entries. The memory
+ * starts out zeroed.
+ */
+class FrameArena {
+ public:
+  /**
+   * Map a new FrameArena.
+   * @param num_frames number of frames of PAGE_SIZE bytes
+   * @param numa_node the NUMA node to place the memory on
+   */
+  FrameArena(size_t num_frames, uint32_t numa_node);
+
+  ~FrameArena();
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /**
+   * @param frame_id id of a frame
+   * @return the data of the frame
+   */
+  auto GetFrame(size_t frame_id) -> char * { return base_ + frame_id * PAGE_SIZE; }
+
+  /**
+   * Hand the memory of unused frames back to the operating system, as far as the page size of the mapping allows.
+   * The frames read as zeroes when they are used again.
+   * @param first_frame_id id of the first frame
+   * @param num_frames number of frames
+   */
+  void Release(size_t first_frame_id, size_t num_frames);
+
+  /** @return true if the arena is backed by explicitly reserved huge pages */
+  auto IsHugeTlb() const -> bool { return huge_tlb_; }
+
+ private:
+  /** Start of the frames. */
+  char *base_;
+  /** Size of the mapping in bytes, a multiple of HUGE_PAGE_SIZE. */
+  size_t size_;
+  /** True if the mapping uses MAP_HUGETLB. */
+  bool huge_tlb_ = false;
+};
+
+}  // namespace bustub
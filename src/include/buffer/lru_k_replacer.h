@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * Every Pin counts as an access of the frame. The replacer remembers the timestamps of the last K accesses of each
+ * frame and evicts the frame with the largest backward K-distance, i.e. the one whose K-th most recent access is the
+ * oldest. Frames with fewer than K accesses have an infinite backward K-distance and are evicted first, in the order
+ * of their first access. A single sequential scan therefore only displaces frames that were touched once.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of accesses remembered per frame
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  auto Victim(frame_id_t *frame_id) -> bool override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  auto EvictionOrder() -> std::vector<frame_id_t> override;
+
+ private:
+  using Entry = std::pair<size_t, frame_id_t>;
+
+  /** @return the eviction key of a frame: its first access below K accesses, its K-th most recent access otherwise */
+  auto Key(frame_id_t frame_id) const -> Entry;
+
+  /** Take a frame out of the eviction sets if it is there. Requires the latch. */
+  void Erase(frame_id_t frame_id);
+
+  const size_t k_;
+  /** Logical clock, advanced on every access. */
+  size_t current_timestamp_ = 0;
+  /** Ring buffers of the last k_ access timestamps, k_ slots per frame. */
+  std::vector<size_t> history_;
+  /** Number of accesses recorded per frame since it was last evicted. */
+  std::vector<size_t> access_count_;
+  /** True if the frame is unpinned and may be victimized. */
+  std::vector<bool> evictable_;
+  /** Evictable frames with fewer than k_ accesses, ordered by first access. */
+  std::set<Entry> history_set_;
+  /** Evictable frames with at least k_ accesses, ordered by K-th most recent access. */
+  std::set<Entry> cache_set_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -12,9 +12,7 @@
 
 #pragma once
 
-#include <list>
 #include <mutex>  // NOLINT
-#include <algorithm>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -24,6 +22,10 @@ namespace bustub {
 
 /**
  * LRUReplacer implements the Least Recently Used replacement policy.
+ *
+ * The unpinned frames form an intrusive doubly linked list threaded through two arrays indexed by frame id, so that
+ * Pin, Unpin and Victim are O(1) and never allocate. Slot num_pages is the sentinel of the circular list: its next
+ * frame is the least recently unpinned one.
  */
 class LRUReplacer : public Replacer {
  public:
@@ -46,9 +48,23 @@ class LRUReplacer : public Replacer {
 
   auto Size() -> size_t override;
 
+  auto EvictionOrder() -> std::vector<frame_id_t> override;
+
  private:
-  // TODO(student): implement me!
-  std::list<frame_id_t> frame_list_;
+  /** Marks a frame that is not in the list. */
+  static constexpr frame_id_t NOT_IN_LIST = -1;
+
+  /** Unlink a frame from the list. Requires the latch. */
+  void Unlink(frame_id_t frame_id);
+
+  /** Index of the sentinel slot. */
+  const frame_id_t sentinel_;
+  /** Previous frame in the list, or NOT_IN_LIST. */
+  std::vector<frame_id_t> prev_;
+  /** Next frame in the list, or NOT_IN_LIST. */
+  std::vector<frame_id_t> next_;
+  /** Number of frames in the list. */
+  size_t size_ = 0;
   std::mutex latch_;
 };
 
@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// optimistic_page_guard.h
+//
+// Identification: src/include/buffer/optimistic_page_guard.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * OptimisticPageGuard runs a read-only access to a page as a sequence of attempts. An attempt reads the page
+ * without pinning or latching it, and Validate() checks afterwards that no writer modified the page and that the
+ * frame was not reused in the meantime. After OPTIMISTIC_READ_RETRIES failed attempts the guard falls back to a
+ * pinned, read latched page, which always validates. The data of a failed attempt may be torn, so the reader must
+ * not trust it beyond staying within the bounds of the page.
+ *
+ *   OptimisticPageGuard guard(bpm, page_id);
+ *   do {
+ *     auto *data = guard.GetData();
+ *     ... read from data ...
+ *   } while (!guard.Validate());
+ */
+class OptimisticPageGuard {
+ public:
+  /**
+   * Create an OptimisticPageGuard and start the first attempt.
+   * @param bpm the buffer pool manager holding the page
+   * @param page_id id of the page to be read
+   * @param priority the priority hint used when the page has to be fetched
+   */
+  OptimisticPageGuard(BufferPoolManager *bpm, page_id_t page_id, PagePriority priority = PagePriority::NORMAL)
+      : bpm_(bpm), page_id_(page_id), priority_(priority) {
+    Begin();
+  }
+
+  ~OptimisticPageGuard() { Release(); }
+
+  DISALLOW_COPY(OptimisticPageGuard);
+
+  /**
+   * @return the data of the page for the current attempt, nullptr if the page could not be fetched at all. The data
+   * must only be read.
+   */
+  auto GetData() -> char * { return page_ == nullptr ? nullptr : page_->GetData(); }
+
+  /** @return true if the current attempt reads the page without pin or latch */
+  auto IsOptimistic() const -> bool { return !pinned_; }
+
+  /**
+   * Check the reads of the current attempt. If they may be inconsistent, a new attempt is started.
+   * @return true if everything read since the attempt started is consistent
+   */
+  auto Validate() -> bool {
+    if (pinned_ || page_ == nullptr) {
+      return true;
+    }
+    if (page_->ValidateVersion(version_)) {
+      return true;
+    }
+    attempts_++;
+    Begin();
+    return false;
+  }
+
+ private:
+  void Begin() {
+    if (attempts_ < OPTIMISTIC_READ_RETRIES) {
+      page_ = bpm_->FetchPageOptimistic(page_id_, &version_);
+      if (page_ != nullptr) {
+        return;
+      }
+    }
+    // The page is not resident, busy, or keeps changing under us: read it the pessimistic way.
+    page_ = bpm_->FetchPageWithPriority(page_id_, priority_);
+    if (page_ != nullptr) {
+      page_->RLatch();
+      pinned_ = true;
+    }
+  }
+
+  void Release() {
+    if (pinned_) {
+      page_->RUnlatch();
+      bpm_->UnpinPage(page_id_, false);
+      pinned_ = false;
+    }
+  }
+
+  BufferPoolManager *bpm_;
+  page_id_t page_id_;
+  PagePriority priority_;
+  Page *page_ = nullptr;
+  uint64_t version_ = 0;
+  int attempts_ = 0;
+  bool pinned_ = false;
+};
+
+}  // namespace bustub
@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the page ids held by a buffer pool instance to their frames. It is an open-addressed hash table
+ * with linear probing, sized to at least twice the number of frames, whose slots are single 64-bit atomic words.
+ *
+ * Lookups are lock-free. Insert and Erase must be serialized by the caller (the buffer pool instance latch). Erase
+ * shifts the following entries back instead of leaving tombstones, so a concurrent lookup may miss an entry that is
+ * being moved. A lookup that finds nothing is therefore only a hint; callers confirm a miss under the latch, where
+ * lookups are exact. A lookup may also still return an entry that is being erased, so callers check the frame they
+ * get back.
+ */
+class PageTable {
+ public:
+  /**
+   * Create a new PageTable.
+   * @param num_frames the maximum number of entries the table has to hold
+   */
+  explicit PageTable(size_t num_frames);
+
+  DISALLOW_COPY(PageTable);
+
+  /**
+   * Look up a page. Lock-free.
+   * @param page_id id of the page
+   * @param[out] frame_id the frame holding the page
+   * @return true if the page was found
+   */
+  auto Find(page_id_t page_id, frame_id_t *frame_id) const -> bool;
+
+  /**
+   * Map a page to a frame, replacing any existing mapping of the page. Requires external synchronization.
+   * @param page_id id of the page
+   * @param frame_id the frame holding the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Remove the mapping of a page. Requires external synchronization.
+   * @param page_id id of the page
+   * @return true if the page was mapped
+   */
+  auto Erase(page_id_t page_id) -> bool;
+
+  /** @return the number of mapped pages. Exact only under external synchronization. */
+  auto Size() const -> size_t { return size_.load(std::memory_order_relaxed); }
+
+  /**
+   * Call a function for every mapping. Requires external synchronization.
+   * @param fn the function to call with each page id and frame id
+   */
+  void ForEach(const std::function<void(page_id_t, frame_id_t)> &fn) const;
+
+ private:
+  static constexpr uint64_t EMPTY = ~static_cast<uint64_t>(0);
+
+  static auto Pack(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static auto PageOf(uint64_t entry) -> page_id_t { return static_cast<page_id_t>(entry >> 32); }
+  static auto FrameOf(uint64_t entry) -> frame_id_t { return static_cast<frame_id_t>(entry & 0xFFFFFFFF); }
+
+  /** @return the slot a page id hashes to */
+  auto Home(page_id_t page_id) const -> size_t;
+
+  std::vector<std::atomic<uint64_t>> slots_;
+  size_t mask_;
+  std::atomic<size_t> size_{0};
+};
+
+}  // namespace bustub
@@ -13,9 +13,11 @@
 #pragma once
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
+#include <atomic>
 #include <vector>
 
 namespace bustub {
@@ -28,9 +30,12 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    * @param pool_size the pool size of each BufferPoolManagerInstance
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_policy the replacement policy of every BufferPoolManagerInstance
+   * @param max_pool_size the pool size each BufferPoolManagerInstance may grow to, 0 for pool_size
    */
   ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, ReplacerPolicy replacer_policy = ReplacerPolicy::LRU,
+                            size_t max_pool_size = 0);
 
   /**
    * Destroys an existing ParallelBufferPoolManager.
@@ -54,6 +59,61 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    */
   auto FetchPgImp(page_id_t page_id) -> Page * override;
 
+  /**
+   * Fetch the requested page from the buffer pool using an access strategy.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the caller, may be nullptr
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override;
+
+  /**
+   * Fetch the requested page from the buffer pool with a priority hint.
+   * @param page_id id of page to be fetched
+   * @param priority the priority of the page
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id, PagePriority priority) -> Page * override;
+
+  /**
+   * Look up a resident page for an optimistic read, without pinning or latching it.
+   * @param page_id id of page to be read
+   * @param[out] version the version of the page to validate the read against
+   * @return the page, or nullptr if it is not resident, being read in or being modified
+   */
+  auto FetchPgOptimisticImp(page_id_t page_id, uint64_t *version) -> Page * override;
+
+  /**
+   * Fetch the requested page if it is resident and no disk I/O is in flight on it.
+   * @param page_id id of page to be fetched
+   * @return the requested page, or nullptr if it is not ready
+   */
+  auto FetchResidentPgImp(page_id_t page_id) -> Page * override;
+
+  /**
+   * Forward a read-ahead request to the instance responsible for the page.
+   * @param page_id id of page to be read ahead
+   */
+  void PrefetchPgImp(page_id_t page_id) override;
+
+  /**
+   * Fetch a batch of pages. The page ids are grouped by instance and each instance serves its group as one batch.
+   * @param page_ids ids of the pages to be fetched
+   * @param num_pages number of page ids
+   * @param[out] pages the fetched pages, nullptr for pages that could not be fetched
+   * @return true if every page was fetched, false otherwise
+   */
+  auto FetchPgsImp(const page_id_t *page_ids, size_t num_pages, Page **pages) -> bool override;
+
+  /**
+   * Unpin a batch of pages, grouped by instance.
+   * @param page_ids ids of the pages to be unpinned
+   * @param num_pages number of page ids
+   * @param is_dirty true if the pages should be marked as dirty, false otherwise
+   * @return false if the pin count of any page was <= 0 before this call, true otherwise
+   */
+  auto UnpinPgsImp(const page_id_t *page_ids, size_t num_pages, bool is_dirty) -> bool override;
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -70,12 +130,43 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   auto FlushPgImp(page_id_t page_id) -> bool override;
 
   /**
-   * Creates a new page in the buffer pool.
+   * Resize every instance. The number of instances is fixed, since page ids are routed to instances by their value,
+   * so the frames are spread over the existing instances as evenly as possible.
+   * @param pool_size the new total number of frames
+   * @return false if any instance cannot take its share, true otherwise
+   */
+  auto ResizeImp(size_t pool_size) -> bool override;
+
+  /**
+   * Append the ids of the resident pages of all instances, interleaving the instances so that pages of the same rank
+   * in their instance end up next to each other.
+   * @param[out] page_ids the list to append to
+   */
+  void GetResidentPgsImp(std::vector<page_id_t> *page_ids) override;
+
+  /**
+   * Add the statistics of every instance to a snapshot.
+   * @param[out] stats the snapshot
+   */
+  void GetStatsImp(BufferPoolStats *stats) override;
+
+  /**
+   * Creates a new page in the buffer pool. Each thread allocates round robin over the instances on its own NUMA node,
+   * starting from a different instance than other threads, and only falls back to the other nodes once every
+   * instance of its node is full.
    * @param[out] page_id id of created page
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
   auto NewPgImp(page_id_t *page_id) -> Page * override;
 
+  /**
+   * Creates a new page in the buffer pool with a priority hint, allocating like NewPgImp(page_id_t *).
+   * @param[out] page_id id of created page
+   * @param priority the priority of the page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPgImp(page_id_t *page_id, PagePriority priority) -> Page * override;
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
@@ -84,19 +175,29 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   auto DeletePgImp(page_id_t page_id) -> bool override;
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the pages in the buffer pool to disk. The dirty pages of all instances are sorted by page id, so that
+   * consecutive pages of different instances are merged into one write, and written by one thread per instance.
    */
   void FlushAllPgsImp() override;
 
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
   /** How many instances are in the parallel BPM (if present, otherwise just 1 c) */
   const uint32_t num_instances_;
 
-  uint32_t start_index_ = 0;
-
   std::vector<BufferPoolManager*> vec_BPMIs; 
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+
+  /** Pointer to the disk manager. */
+  DiskManager *disk_manager_;
+
+  /** A cursor for round robin page allocation, on a cache line of its own. */
+  struct alignas(CACHE_LINE_SIZE) AllocationCursor {
+    std::atomic<uint32_t> next_{0};
+  };
+  /** Number of allocation cursors; threads beyond that share them. */
+  static constexpr size_t NUM_ALLOCATION_CURSORS = 64;
+
+  /** Indexes of the instances on each NUMA node. */
+  std::vector<std::vector<uint32_t>> node_instances_;
+  /** Allocation cursors, indexed by thread. */
+  std::vector<AllocationCursor> allocation_cursors_;
 };
 }  // namespace bustub
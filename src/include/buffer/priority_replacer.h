@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// priority_replacer.h
+//
+// Identification: src/include/buffer/priority_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/lru_replacer.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PriorityReplacer adds a protected segment for high priority pages on top of another replacer.
+ *
+ * Unpinned frames of high priority pages enter the protected segment instead of the wrapped replacer, and are only
+ * victimized once the wrapped replacer has no frame left, so that a scan flushing the rest of the pool passes them
+ * by. The protected segment is ordered LRU and bounded: when it would grow beyond its capacity, its least recently
+ * used frame is demoted to the wrapped replacer, keeping callers that hint too many pages from starving everyone else.
+ *
+ * Every pin is passed on to the wrapped replacer, also for protected frames, so that a policy like LRU-K keeps the
+ * access history of high priority pages and does not treat them as cold once they are demoted. Frames of normal pages
+ * only touch the wrapped replacer, so its concurrency is unchanged for them.
+ */
+class PriorityReplacer : public Replacer {
+ public:
+  /**
+   * Create a new PriorityReplacer.
+   * @param replacer the replacer ordering the frames of normal pages; the PriorityReplacer takes ownership of it
+   * @param num_pages the maximum number of pages the PriorityReplacer will be required to store
+   * @param max_protected the maximum number of frames in the protected segment
+   */
+  PriorityReplacer(Replacer *replacer, size_t num_pages, size_t max_protected);
+
+  /**
+   * Destroys the PriorityReplacer and the replacer it wraps.
+   */
+  ~PriorityReplacer() override;
+
+  DISALLOW_COPY_AND_MOVE(PriorityReplacer);
+
+  auto Victim(frame_id_t *frame_id) -> bool override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  void SetPriority(frame_id_t frame_id, PagePriority priority) override;
+
+  auto Size() -> size_t override;
+
+  auto EvictionOrder() -> std::vector<frame_id_t> override;
+
+ private:
+  /** The replacer of normal frames. */
+  Replacer *replacer_;
+  /** The protected segment, guarded by the latch so that it never exceeds max_protected_. */
+  LRUReplacer protected_;
+  const size_t max_protected_;
+  /** Whether the page in a frame has high priority. */
+  std::vector<std::atomic<bool>> high_;
+  /** Whether a frame is in the protected segment; only changed under the latch. */
+  std::vector<std::atomic<bool>> in_protected_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -12,10 +12,21 @@
 
 #pragma once
 
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+/** The replacement policies a buffer pool can be built with. */
+enum class ReplacerPolicy { LRU, CLOCK, LRU_K };
+
+/**
+ * How eagerly a page may be evicted, as hinted by the caller fetching it. HIGH is meant for the few pages nearly every
+ * access goes through, like index roots and directories, which should survive a scan of the rest of the database.
+ */
+enum class PagePriority { NORMAL, HIGH };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -43,8 +54,28 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Forget a frame entirely, e.g. because its page was deleted. Replacers that keep per-frame history drop it here.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
+  /**
+   * Set the priority of the page in a frame. It holds until the frame is victimized or removed. Replacers that do not
+   * tell priorities apart ignore it.
+   * @param frame_id the id of the frame
+   * @param priority the priority of its page
+   */
+  virtual void SetPriority(frame_id_t frame_id, PagePriority priority) {}
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual auto Size() -> size_t = 0;
+
+  /**
+   * @return the frames that can be victimized, in the order the replacement policy would pick them, or an empty list
+   * if the replacer cannot tell
+   */
+  virtual auto EvictionOrder() -> std::vector<frame_id_t> { return {}; }
 };
 
 }  // namespace bustub
@@ -13,6 +13,7 @@
 #include <string>
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/buffer_pool_warmer.h"
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
 #include "recovery/checkpoint_manager.h"
@@ -34,6 +35,13 @@ class BustubInstance {
 
     buffer_pool_manager_ = new BufferPoolManagerInstance(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
 
+    // warm-up: load the pages that were resident at the last shutdown, next to the database file
+    if (enable_buffer_pool_warmup) {
+      std::string::size_type n = db_file_name.rfind('.');
+      buffer_pool_warmer_ = new BufferPoolWarmer(buffer_pool_manager_, db_file_name.substr(0, n) + ".warm");
+      buffer_pool_warmer_->RunWarmupThread();
+    }
+
     // txn related
     lock_manager_ = new LockManager();
     transaction_manager_ = new TransactionManager(lock_manager_, log_manager_);
@@ -47,6 +55,7 @@ class BustubInstance {
       log_manager_->StopFlushThread();
     }
     delete checkpoint_manager_;
+    delete buffer_pool_warmer_;
     delete log_manager_;
     delete buffer_pool_manager_;
     delete lock_manager_;
@@ -56,6 +65,7 @@ class BustubInstance {
 
   DiskManager *disk_manager_;
   BufferPoolManager *buffer_pool_manager_;
+  BufferPoolWarmer *buffer_pool_warmer_ = nullptr;
   LockManager *lock_manager_;
   TransactionManager *transaction_manager_;
   LogManager *log_manager_;
@@ -14,8 +14,17 @@
 
 #include <atomic>
 #include <chrono>  // NOLINT
+#include <cstddef>
 #include <cstdint>
 
+/**
+ * The size of a page, on disk and in the buffer pool, is fixed when BusTub is built (cmake -DBUSTUB_PAGE_SIZE=16384)
+ * because every page layout derives from it. Database files do not carry over between builds with different sizes.
+ */
+#ifndef BUSTUB_PAGE_SIZE
+#define BUSTUB_PAGE_SIZE 4096
+#endif
+
 namespace bustub {
 
 /** Cycle detection is performed every CYCLE_DETECTION_INTERVAL milliseconds. */
@@ -27,14 +36,72 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** The page cleaner of every buffer pool instance wakes up at least every PAGE_CLEANER_INTERVAL milliseconds. */
+extern std::chrono::milliseconds page_cleaner_interval;
+
+/** Shrinking a buffer pool gives up once a page in a frame it gives up stays pinned for RESIZE_TIMEOUT. */
+extern std::chrono::milliseconds resize_timeout;
+
+/** The page cleaner tries to keep this many clean frames on the free list (at most a quarter of the pool). */
+extern std::atomic<size_t> page_cleaner_free_frames;
+
+/** Number of pages a sequential table scan keeps read ahead of its cursor (0 disables read-ahead). */
+extern std::atomic<size_t> scan_prefetch_window;
+
+/**
+ * Bytes of memory every buffer pool instance created from now on may use to keep compressed copies of the clean
+ * pages it evicts (0 disables the compressed page cache).
+ */
+extern std::atomic<size_t> compressed_page_cache_size;
+
+/**
+ * True if disk managers created from now on should read and write the database file with direct I/O (O_DIRECT),
+ * bypassing the page cache of the operating system. File systems that do not support it fall back to buffered I/O.
+ */
+extern std::atomic<bool> enable_direct_io;
+
+/** True if disk managers should serve asynchronous requests with io_uring where the system supports it. */
+extern std::atomic<bool> enable_io_uring;
+
+/**
+ * Pages per second the background I/O of a disk, read-ahead and page cleaner write-back, may transfer (0 disables
+ * the limit).
+ */
+extern std::atomic<size_t> background_io_rate_limit;
+
+/** True if a BustubInstance should save its resident pages on shutdown and load them again on startup. */
+extern std::atomic<bool> enable_buffer_pool_warmup;
+
+/** While warm-up is enabled, the resident pages are also saved every WARMUP_SAVE_INTERVAL. */
+extern std::chrono::milliseconds warmup_save_interval;
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
-static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int PAGE_SIZE = BUSTUB_PAGE_SIZE;                            // size of a data page in byte
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int PAGE_CLEANER_BATCH_SIZE = 64;                            // max pages written per cleaner pass
+static constexpr int LRUK_REPLACER_K = 2;                                     // lookback window for lru-k replacer
+static constexpr int SCAN_RING_SIZE = 32;                                     // frames recycled by a bulk read
+static constexpr int PREFETCH_QUEUE_SIZE = 64;                                // max pending read-ahead requests
+static constexpr int OPTIMISTIC_READ_RETRIES = 3;                             // before falling back to the latch
+static constexpr int CACHE_LINE_SIZE = 64;                                    // size of a cpu cache line in byte
+static constexpr int HUGE_PAGE_SIZE = 2 * 1024 * 1024;                        // size of a huge page in byte
+static constexpr int WARMUP_BATCH_SIZE = 32;                                  // pages fetched at once by warm-up
+static constexpr int FLUSH_MAX_RUN = 64;                                      // max pages per coalesced read or write
+static constexpr int HIGH_PRIORITY_PERCENT = 25;                              // max share of high priority frames
+static constexpr int DIRECT_IO_ALIGNMENT = 4096;                              // buffer alignment for direct I/O
+static constexpr int ASYNC_IO_QUEUE_DEPTH = 128;                              // max async requests in flight
+static constexpr int ASYNC_IO_THREADS = 4;                                    // threads serving async requests
+static constexpr int IO_SCHEDULER_DEPTH = 32;                                 // max scheduled I/Os running per disk
+static constexpr int BACKGROUND_IO_BURST = 64;                                // pages background I/O may save up
+
+static_assert(PAGE_SIZE >= 4096 && PAGE_SIZE <= 65536 && (PAGE_SIZE & (PAGE_SIZE - 1)) == 0,
+              "the page size must be a power of two between 4 KB and 64 KB");
+static_assert(PAGE_SIZE % DIRECT_IO_ALIGNMENT == 0, "pages must stay aligned for direct I/O");
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -0,0 +1,48 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz_util.h
+//
+// Identification: src/include/common/util/lz_util.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * LZUtil is a small, fast LZ77 codec for pages, in the spirit of LZ4. The compressed form is a sequence of
+ * (literals, match) pairs: a token byte holding both lengths, the literal bytes, and a two byte offset back into the
+ * output from which the match is copied. Matches may overlap their own output, so runs of one byte, such as the
+ * free space of a page, shrink to a few bytes.
+ */
+class LZUtil {
+ public:
+  /**
+   * Compress a buffer.
+   * @param src the data to compress
+   * @param src_size the size of the data
+   * @param[out] dst the buffer receiving the compressed data
+   * @param dst_capacity the size of dst
+   * @return the size of the compressed data, 0 if it does not fit into dst
+   */
+  static auto Compress(const char *src, size_t src_size, char *dst, size_t dst_capacity) -> size_t;
+
+  /**
+   * Decompress a buffer produced by Compress. Corrupt input is detected, never read or written out of bounds.
+   * @param src the compressed data
+   * @param src_size the size of the compressed data
+   * @param[out] dst the buffer receiving the data
+   * @param dst_size the size of the original data
+   * @return true if the data was restored, false if src is corrupt or does not decompress to dst_size bytes
+   */
+  static auto Decompress(const char *src, size_t src_size, char *dst, size_t dst_size) -> bool;
+};
+
+}  // namespace bustub
@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// numa_util.h
+//
+// Identification: src/include/common/util/numa_util.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#ifdef BUSTUB_ENABLE_NUMA
+#include <numa.h>
+#include <sched.h>
+#endif
+
+namespace bustub {
+
+/**
+ * NumaUtil places memory on NUMA nodes. Without the BUSTUB_ENABLE_NUMA build option, or on a machine without NUMA
+ * support, the whole machine is treated as a single node and memory comes from the regular heap.
+ */
+class NumaUtil {
+ public:
+  /** @return the number of NUMA nodes memory can be placed on, at least 1 */
+  static auto NodeCount() -> uint32_t {
+#ifdef BUSTUB_ENABLE_NUMA
+    if (Available()) {
+      int nodes = numa_num_configured_nodes();
+      return nodes > 0 ? static_cast<uint32_t>(nodes) : 1;
+    }
+#endif
+    return 1;
+  }
+
+  /** @return the node the calling thread is currently running on */
+  static auto CurrentNode() -> uint32_t {
+#ifdef BUSTUB_ENABLE_NUMA
+    if (Available()) {
+      int cpu = sched_getcpu();
+      int node = cpu < 0 ? -1 : numa_node_of_cpu(cpu);
+      return node < 0 ? 0 : static_cast<uint32_t>(node);
+    }
+#endif
+    return 0;
+  }
+
+  /**
+   * Allocate page aligned memory placed on a node. The memory is not initialized.
+   * @param size number of bytes to allocate
+   * @param node the node to place the memory on
+   * @return the allocated memory, to be released with Free()
+   */
+  static auto AllocateOnNode(size_t size, uint32_t node) -> void * {
+#ifdef BUSTUB_ENABLE_NUMA
+    if (Available()) {
+      void *ptr = numa_alloc_onnode(size, static_cast<int>(node));
+      if (ptr == nullptr) {
+        throw std::bad_alloc();
+      }
+      return ptr;
+    }
+#endif
+    return ::operator new(size, std::align_val_t{PAGE_ALIGNMENT});
+  }
+
+  /**
+   * Release memory allocated by AllocateOnNode().
+   * @param ptr the memory
+   * @param size number of bytes that were allocated
+   */
+  static void Free(void *ptr, size_t size) {
+#ifdef BUSTUB_ENABLE_NUMA
+    if (Available()) {
+      numa_free(ptr, size);
+      return;
+    }
+#endif
+    ::operator delete(ptr, std::align_val_t{PAGE_ALIGNMENT});
+  }
+
+  /**
+   * Place memory that was mapped but not touched yet on a node.
+   * @param ptr page aligned start of the memory
+   * @param size number of bytes
+   * @param node the node to place the memory on
+   */
+  static void BindToNode(void *ptr, size_t size, uint32_t node) {
+#ifdef BUSTUB_ENABLE_NUMA
+    if (Available()) {
+      numa_tonode_memory(ptr, size, static_cast<int>(node));
+    }
+#endif
+  }
+
+ private:
+  /** Alignment of the memory returned by AllocateOnNode(), the size of an OS page. */
+  static constexpr size_t PAGE_ALIGNMENT = 4096;
+
+#ifdef BUSTUB_ENABLE_NUMA
+  static auto Available() -> bool {
+    static const bool available = numa_available() >= 0;
+    return available;
+  }
+#endif
+};
+
+}  // namespace bustub
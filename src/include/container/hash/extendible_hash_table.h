@@ -128,6 +128,15 @@ class ExtendibleHashTable {
    */
   auto FetchDirectoryPage() -> HashTableDirectoryPage *;
 
+  /**
+   * Looks up the page id of the bucket a key belongs to. The directory page is read optimistically, without pinning
+   * or latching it, unless it is not resident or keeps changing.
+   *
+   * @param key the key
+   * @return the bucket page_id corresponding to the input key
+   */
+  auto ReadBucketPageId(const KeyType &key) -> page_id_t;
+
   /**
    * Fetches the a bucket page from the buffer pool manager using the bucket's page_id.
    *
@@ -14,6 +14,7 @@
 
 #include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
@@ -53,6 +54,8 @@ class SeqScanExecutor : public AbstractExecutor {
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
   TableInfo *table_info_;
+  /** Bulk read strategy, so that the scan recycles a small ring of frames instead of flushing the buffer pool */
+  BufferAccessStrategy strategy_;
   TableIterator iter_;
 
 };
@@ -12,19 +12,53 @@
 
 #pragma once
 
+#include <sys/uio.h>
+
 #include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <fstream>
+#include <functional>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
+#include <shared_mutex>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/io_scheduler.h"
+#include "storage/disk/io_uring.h"
 
 namespace bustub {
 
+/**
+ * DiskManagerClient is something that holds pages of a disk manager in memory, like a buffer pool instance. A client
+ * attached to a disk manager is detached before the disk manager shuts down or is destroyed, so that it can write what
+ * it holds while the database file is still open.
+ */
+class DiskManagerClient {
+ public:
+  virtual ~DiskManagerClient() = default;
+
+  /** Write back the pages held and stop using the disk manager for I/O in the background. */
+  virtual void DetachDiskManager() = 0;
+};
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Pages are read and written with positional I/O on a file descriptor, so that any number of threads, e.g. the
+ * instances of a parallel buffer pool, can do page I/O at the same time without a common lock. A write only hands the
+ * page to the operating system; it is durable once Sync() returns. With enable_direct_io, the database file bypasses
+ * the operating system's page cache.
+ *
+ * Pages can also be read and written asynchronously, so that one thread can keep many requests in flight. On Linux
+ * the requests go through an io_uring, which reads and writes the frames of the buffer pools registered with
+ * RegisterBuffers() without mapping them on every request. Where io_uring is not available, or enable_io_uring is
+ * off, a pool of ASYNC_IO_THREADS threads serves them with positional I/O.
  */
 class DiskManager {
  public:
@@ -34,13 +68,35 @@ class DiskManager {
    */
   explicit DiskManager(const std::string &db_file);
 
-  ~DiskManager() = default;
+  /** Closes the database file if ShutDown() was not called. */
+  virtual ~DiskManager();
+
+  DISALLOW_COPY_AND_MOVE(DiskManager);
 
   /**
-   * Shut down the disk manager and close all the file resources.
+   * Shut down the disk manager, making the database file durable, and close all the file resources. The clients are
+   * detached first.
    */
   void ShutDown();
 
+  /**
+   * Attach a client, to be detached when the disk manager shuts down or is destroyed. Clients are not detached
+   * concurrently with their own destruction; tearing down the disk manager and its clients is left to one thread.
+   * @param client the client
+   */
+  void AddClient(DiskManagerClient *client);
+
+  /**
+   * Forget a client that detached on its own. Does nothing if it was detached already.
+   * @param client the client
+   */
+  void RemoveClient(DiskManagerClient *client);
+
+  /**
+   * Make every page written so far durable. Returns immediately if nothing was written since the last call.
+   */
+  virtual void Sync();
+
   /**
    * Write a page to the database file.
    * @param page_id id of the page
@@ -48,6 +104,15 @@ class DiskManager {
    */
   void WritePage(page_id_t page_id, const char *page_data);
 
+  /**
+   * Write consecutive pages to the database file with one vectored write, so the data need not be contiguous.
+   * @param first_page_id id of the first page
+   * @param pages_data raw data of the pages first_page_id, first_page_id + 1, ...
+   * @param num_pages number of pages
+   * @return false on an I/O error, in which case any of the pages may not have been written
+   */
+  auto WritePages(page_id_t first_page_id, const char *const *pages_data, size_t num_pages) -> bool;
+
   /**
    * Read a page from the database file.
    * @param page_id id of the page
@@ -55,12 +120,94 @@ class DiskManager {
    */
   void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Read consecutive pages from the database file with one vectored read. Pages beyond the end of the file are
+   * zeroed.
+   * @param first_page_id id of the first page
+   * @param[out] pages_data output buffers of the pages first_page_id, first_page_id + 1, ...
+   * @param num_pages number of pages
+   */
+  void ReadPages(page_id_t first_page_id, char *const *pages_data, size_t num_pages);
+
+  /** Called when an asynchronous request completes, with true if the I/O succeeded. */
+  using DiskCallback = std::function<void(bool)>;
+
+  /** An asynchronous read or write of a page. */
+  struct DiskRequest {
+    /** True to write the page, false to read it. */
+    bool is_write_;
+    page_id_t page_id_;
+    /** The page to write, or the buffer to read it into; it must stay valid until the callback runs. */
+    char *data_;
+    /** Called once the request completed, from a thread of the disk manager; it must not block. */
+    DiskCallback callback_;
+  };
+
+  /**
+   * Start a batch of asynchronous requests, handing them to the kernel at once where possible. Blocks only while as
+   * many requests as the backend takes are in flight already.
+   * @param requests the requests; their callbacks are moved out
+   * @param num_requests number of requests
+   */
+  void SubmitRequests(DiskRequest *requests, size_t num_requests);
+
+  /**
+   * Read a page asynchronously.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, valid until the callback runs
+   * @param callback called once the page is read
+   */
+  void ReadPageAsync(page_id_t page_id, char *page_data, DiskCallback callback);
+
+  /**
+   * Write a page asynchronously.
+   * @param page_id id of the page
+   * @param page_data raw page data, valid until the callback runs
+   * @param callback called once the page is written
+   */
+  void WritePageAsync(page_id_t page_id, const char *page_data, DiskCallback callback);
+
+  /**
+   * Read a page asynchronously.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, valid until the future is ready
+   * @return a future telling whether the read succeeded
+   */
+  auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<bool>;
+
+  /**
+   * Write a page asynchronously.
+   * @param page_id id of the page
+   * @param page_data raw page data, valid until the future is ready
+   * @return a future telling whether the write succeeded
+   */
+  auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<bool>;
+
+  /**
+   * Register memory that pages are read into and written from, like the frames of a buffer pool, so that asynchronous
+   * requests can use it without the kernel mapping it on every request. The memory is pinned while it is registered
+   * and must not be unmapped or remapped before UnregisterBuffers().
+   * @param base start of the memory
+   * @param size size of the memory in bytes
+   * @return true if the memory was registered, false if the backend does not support it or the kernel refused
+   */
+  auto RegisterBuffers(char *base, size_t size) -> bool;
+
+  /**
+   * Unregister memory registered with RegisterBuffers(). Does nothing after ShutDown().
+   * @param base start of the memory
+   */
+  void UnregisterBuffers(char *base);
+
+  /** @return true if asynchronous requests go through an io_uring */
+  auto IsIoUring() -> bool;
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
    * @param size size of log entry
    */
-  void WriteLog(char *log_data, int size);
+  virtual void WriteLog(char *log_data, int size);
 
   /**
    * Read a log entry from the log file.
@@ -69,7 +216,16 @@ class DiskManager {
    * @param offset offset of the log entry in the file
    * @return true if the read was successful, false otherwise
    */
-  auto ReadLog(char *log_data, int size, int offset) -> bool;
+  virtual auto ReadLog(char *log_data, int size, int offset) -> bool;
+
+  /** @return the scheduler that the I/O of the database file should go through */
+  auto GetIoScheduler() -> IoScheduler * { return &io_scheduler_; }
+
+  /** @return the size of the database file in bytes */
+  auto GetDbFileSize() const -> int64_t { return db_file_size_; }
+
+  /** @return true if the database file was opened for direct I/O */
+  auto IsDirectIo() const -> bool { return direct_io_; }
 
   /** @return the number of disk flushes */
   auto GetNumFlushes() const -> int;
@@ -89,20 +245,76 @@ class DiskManager {
   /** Checks if the non-blocking flush future was set. */
   inline auto HasFlushLogFuture() -> bool { return flush_log_f_ != nullptr; }
 
+ protected:
+  /**
+   * Creates a disk manager without files, for subclasses that keep the pages elsewhere. They override the page I/O
+   * below, Sync() and the log I/O; the public methods, including the asynchronous ones, are built on them.
+   */
+  DiskManager();
+
+  /**
+   * Write a page at its offset. The data is copied to an aligned buffer first if direct I/O requires it.
+   * @return false on an I/O error
+   */
+  virtual auto WritePageAt(page_id_t page_id, const char *page_data) -> bool;
+  /** Read a page at its offset, like WritePageAt(). @return false on an I/O error */
+  virtual auto ReadPageAt(page_id_t page_id, char *page_data) -> bool;
+  /**
+   * Read or write consecutive pages with one vectored system call, through aligned buffers if direct I/O requires
+   * them. @return false on an I/O error
+   */
+  virtual auto TransferPagesAt(bool is_write, page_id_t first_page_id, char *const *pages_data, size_t num_pages)
+      -> bool;
+  /** Account for a page written: the file needs a sync and may have grown. */
+  void NoteWrite(page_id_t page_id);
+  /** Wait for the asynchronous requests in flight and stop their backend. Subclasses call it in their destructor. */
+  void StopAsyncIo();
+  /** Detach every client. Subclasses call it in their destructor, before StopAsyncIo(). */
+  void DetachClients();
+
+  // size of the db file, kept up to date by the writes instead of asking the file system on every read
+  std::atomic<int64_t> db_file_size_{0};
+  // true if pages were written since the last fdatasync
+  std::atomic<bool> unsynced_writes_{false};
+  int num_flushes_ = 0;
+  bool flush_log_ = false;
+  std::future<void> *flush_log_f_ = nullptr;
+
  private:
   auto GetFileSize(const std::string &file_name) -> int;
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  /** Start the io_uring or the thread pool serving asynchronous requests on first use. Requires the async latch. */
+  void StartAsyncIo();
+  /** Complete an asynchronous request that went through the io_uring. */
+  void CompleteRequest(DiskRequest *request, ssize_t result);
+  /** Serve the asynchronous requests queued for the thread pool. */
+  void RunIoWorker();
+  // descriptor of the db file, -1 once it is closed
+  int db_fd_ = -1;
+  bool direct_io_ = false;
   std::string file_name_;
-  int num_flushes_;
-  int num_writes_;
-  bool flush_log_;
-  std::future<void> *flush_log_f_;
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
+  std::atomic<int> num_writes_{0};
+
+  // held shared by submissions, and exclusively to stop the asynchronous I/O backend
+  std::shared_mutex submit_latch_;
+  // protects the setup of the asynchronous I/O backend, the registered buffers and the queue of the thread pool
+  std::mutex async_latch_;
+  std::atomic<bool> async_started_{false};
+  std::atomic<bool> async_stopped_{false};
+  IoUring *io_uring_ = nullptr;
+  std::vector<iovec> registered_buffers_;
+  std::vector<std::thread> io_workers_;
+  std::deque<DiskRequest> io_queue_;
+  std::condition_variable io_queue_cv_;
+
+  // protects the clients, which are detached before the disk manager stops
+  std::mutex clients_latch_;
+  std::vector<DiskManagerClient *> clients_;
+
+  // orders the I/O of the buffer pools, the page cleaners and read-ahead on this file
+  IoScheduler io_scheduler_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_memory.h
+//
+// Identification: src/include/storage/disk/disk_manager_memory.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * The latency of one kind of disk operation: a fixed part, plus a random part drawn from a distribution.
+ */
+struct LatencyDistribution {
+  enum class Kind {
+    /** Always base_. */
+    FIXED,
+    /** base_ plus a uniform draw from [0, jitter_]. */
+    UNIFORM,
+    /** base_ plus an exponential draw with mean jitter_, a long tail like the one of real devices. */
+    EXPONENTIAL,
+  };
+
+  Kind kind_ = Kind::FIXED;
+  std::chrono::microseconds base_{0};
+  std::chrono::microseconds jitter_{0};
+};
+
+/**
+ * How a simulated disk behaves. Every read or write, of one page or of a run of consecutive pages, costs one draw
+ * of its latency plus the time to transfer its bytes, and a Sync() after writes costs one draw of its latency.
+ */
+struct DiskLatencyModel {
+  LatencyDistribution read_;
+  LatencyDistribution write_;
+  LatencyDistribution sync_;
+  /** Bytes per second a read or write transfers, so that larger I/Os take longer. 0 means no limit. */
+  size_t bandwidth_ = 0;
+  /** Number of operations the device serves at once; more wait for one to finish. 0 means no limit. */
+  size_t concurrency_ = 0;
+
+  /** @return a model of an NVMe SSD: tens of microseconds per I/O and a deep queue */
+  static auto Nvme() -> DiskLatencyModel;
+
+  /** @return a model of a hard disk: milliseconds of seek and rotation per I/O, one at a time */
+  static auto Hdd() -> DiskLatencyModel;
+};
+
+/**
+ * DiskManagerMemory is a drop-in DiskManager that keeps the pages in memory instead of a file, so that benchmarks of
+ * the buffer pool, the indexes and the executors do not depend on the file system of the host. An optional latency
+ * model emulates a given device, e.g. an NVMe SSD or a hard disk, reproducibly and without the hardware.
+ *
+ * Pages live in chunks that never move, so the memory grows without copying and any number of threads can read and
+ * write pages at once. The log is kept in memory as well.
+ */
+class DiskManagerMemory : public DiskManager {
+ public:
+  /**
+   * Creates a new memory-backed disk manager.
+   * @param latency the latency model, none by default
+   */
+  explicit DiskManagerMemory(const DiskLatencyModel &latency = {});
+
+  ~DiskManagerMemory() override;
+
+  DISALLOW_COPY_AND_MOVE(DiskManagerMemory);
+
+  /** Make every page written so far durable, which costs a draw of the sync latency if pages were written. */
+  void Sync() override;
+
+  void WriteLog(char *log_data, int size) override;
+
+  auto ReadLog(char *log_data, int size, int offset) -> bool override;
+
+ protected:
+  auto WritePageAt(page_id_t page_id, const char *page_data) -> bool override;
+
+  auto ReadPageAt(page_id_t page_id, char *page_data) -> bool override;
+
+  auto TransferPagesAt(bool is_write, page_id_t first_page_id, char *const *pages_data, size_t num_pages)
+      -> bool override;
+
+ private:
+  /** Number of pages in a chunk of memory. */
+  static constexpr size_t CHUNK_PAGES = 256;
+
+  /** Occupy a channel of the device for a draw of the latency plus the transfer of num_bytes. */
+  void Delay(const LatencyDistribution &latency, size_t num_bytes = 0);
+
+  /** @return the memory of a page, or nullptr if it was never written. Requires the chunks latch. */
+  auto PageData(page_id_t page_id) const -> char *;
+
+  const DiskLatencyModel latency_;
+  /** Protects the list of chunks, exclusively only while it grows. */
+  mutable std::shared_mutex chunks_latch_;
+  std::vector<std::unique_ptr<char[]>> chunks_;
+
+  /** Channels of the device in use, at most latency_.concurrency_. */
+  std::mutex channel_latch_;
+  std::condition_variable channel_cv_;
+  size_t busy_channels_ = 0;
+
+  std::mutex log_latch_;
+  std::string log_;
+};
+
+}  // namespace bustub
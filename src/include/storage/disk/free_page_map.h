@@ -0,0 +1,141 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_map.h
+//
+// Identification: src/include/storage/disk/free_page_map.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * FreePageMap hands out the page ids of one buffer pool instance and keeps track of the pages deleted from it, so
+ * that their space in the database file is reused instead of growing the file forever.
+ *
+ * An instance owns the page ids that are congruent to its index modulo the number of instances; the n-th of them is
+ * its local page n. Local pages are grouped into extents of EXTENT_SIZE pages. The last page of every extent is a map
+ * page, a bitmap with one bit per page of the extent that is set while the page is free. Map pages sit at fixed
+ * places, so the map is found again after a restart without any other metadata, and they are only written once their
+ * extent has a free page. The first pages of the file are ordinary pages, like the header page.
+ *
+ * After a restart the pages up to the end of the file count as allocated. A map page at the end of the file records
+ * how far its extent was allocated instead, and allocating past that mark writes the map page first; the mark moves
+ * RESERVE_SIZE pages at a time, so this costs one write per RESERVE_SIZE pages.
+ *
+ * A page freed reaches its map page lazily, by Flush(); losing that on a crash only leaks the page. A page reused
+ * must not be written before its map page, or the map on disk would claim a page in use is free: WriteAllocations()
+ * writes what allocations need. Pages are reused next-fit from the page reused last, which keeps pages allocated one
+ * after the other close on disk.
+ */
+class FreePageMap {
+ public:
+  /** Size of the header of a map page in bytes. */
+  static constexpr size_t HEADER_SIZE = 16;
+  /** Number of local pages in an extent, including its map page. */
+  static constexpr size_t EXTENT_SIZE = (PAGE_SIZE - HEADER_SIZE) * 8;
+  /** Number of pages the allocation mark of a map page on disk moves ahead at a time. */
+  static constexpr size_t RESERVE_SIZE = 64;
+
+  /**
+   * Create the map of an instance and load it from the database file. Pages beyond the end of the file are
+   * considered never allocated.
+   * @param disk_manager the disk manager of the database file
+   * @param num_instances number of instances the page ids are striped over
+   * @param instance_index index of the instance
+   */
+  FreePageMap(DiskManager *disk_manager, uint32_t num_instances, uint32_t instance_index);
+
+  DISALLOW_COPY_AND_MOVE(FreePageMap);
+
+  /**
+   * Allocate a page, reusing a free one if there is any. Call WriteAllocations() before the page is written.
+   * @param[out] reused true if the page was freed before, so that the file may still hold its old data
+   * @return the id of the page
+   */
+  auto Allocate(bool *reused) -> page_id_t;
+
+  /** Write the map pages that have to reach the disk before the pages allocated so far are written. */
+  void WriteAllocations() {
+    if (allocations_unwritten_) {
+      Flush();
+    }
+  }
+
+  /**
+   * Free a page. Pages never allocated, map pages and pages free already are ignored.
+   * @param page_id id of the page, which must belong to this instance
+   */
+  void Free(page_id_t page_id);
+
+  /** Write the map pages changed since they were last written. */
+  void Flush();
+
+  /** @return the number of free pages */
+  auto GetNumFreePages() -> size_t;
+
+  /**
+   * @param page_id a page id
+   * @param num_instances number of instances the page ids are striped over
+   * @return true if the page is a map page
+   */
+  static auto IsMapPage(page_id_t page_id, uint32_t num_instances) -> bool {
+    return page_id / num_instances % EXTENT_SIZE == EXTENT_SIZE - 1;
+  }
+
+ private:
+  static constexpr uint32_t MAGIC = 0x4d534642;  // "BFSM"
+  static constexpr size_t WORDS_PER_EXTENT = EXTENT_SIZE / 64;
+
+  struct Extent {
+    std::vector<uint64_t> bits_ = std::vector<uint64_t>(WORDS_PER_EXTENT, 0);
+    size_t num_free_ = 0;
+    /** True once the map page is on disk, or about to be. */
+    bool on_disk_ = false;
+    /** Number of pages of the extent the map page on disk counts as allocated. */
+    size_t allocated_ = 0;
+    bool dirty_ = false;
+  };
+
+  auto ToPageId(size_t local) const -> page_id_t {
+    return static_cast<page_id_t>(local * num_instances_ + instance_index_);
+  }
+
+  /** @return the map page of an extent */
+  auto MapPageId(size_t extent) const -> page_id_t { return ToPageId((extent + 1) * EXTENT_SIZE - 1); }
+
+  /** @return the first free local page at or after from, or SIZE_MAX. Requires the latch. */
+  auto FindFree(size_t from) const -> size_t;
+
+  DiskManager *disk_manager_;
+  const uint32_t num_instances_;
+  const uint32_t instance_index_;
+  /** Serializes Flush(), so that map pages reach the disk in the order they were changed. */
+  std::mutex flush_latch_;
+  /** Protects the state below. */
+  std::mutex latch_;
+  /** First local page never allocated. */
+  size_t next_local_ = 0;
+  /** Local page after the page reused last, where the search for a free page starts. */
+  size_t cursor_ = 0;
+  size_t num_free_ = 0;
+  std::vector<Extent> extents_;
+  /** True if an allocation changed a map page that has not been written yet. */
+  std::atomic<bool> allocations_unwritten_{false};
+};
+
+}  // namespace bustub
@@ -0,0 +1,147 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_scheduler.h
+//
+// Identification: src/include/storage/disk/io_scheduler.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <string>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** The kinds of disk traffic the IoScheduler tells apart. */
+enum class IoClass {
+  /** Reads and write-backs a foreground request waits for, like the read of a FetchPage miss. */
+  DEMAND = 0,
+  /** Read-ahead. Background traffic. */
+  PREFETCH,
+  /** Writes of the write-ahead log, which commits wait for. */
+  WAL,
+  /** Write-back of dirty pages by the page cleaner. Background traffic. */
+  WRITE_BACK,
+};
+
+/** Statistics of one class of an IoScheduler. */
+struct IoClassStats {
+  /** Number of I/Os run, and the pages they transferred. */
+  uint64_t requests_ = 0;
+  uint64_t pages_ = 0;
+  /** I/Os waiting to be admitted right now, and the most there ever were. */
+  size_t queue_depth_ = 0;
+  size_t max_queue_depth_ = 0;
+  /** I/Os running right now. */
+  size_t in_flight_ = 0;
+  /** Total and maximum time I/Os waited to be admitted, and total time they took to run, in microseconds. */
+  uint64_t wait_us_ = 0;
+  uint64_t max_wait_us_ = 0;
+  uint64_t service_us_ = 0;
+
+  /** @return the average time from submission to completion of an I/O in microseconds */
+  auto AverageLatency() const -> uint64_t { return requests_ == 0 ? 0 : (wait_us_ + service_us_) / requests_; }
+};
+
+/**
+ * IoScheduler sits in front of the disk and decides which I/O goes next, so that a FetchPage miss does not queue
+ * behind the bulk writes of the page cleaner or behind read-ahead.
+ *
+ * Every I/O goes through Run() with its class. Up to IO_SCHEDULER_DEPTH I/Os run at once; the others wait in one
+ * queue per class. A free slot goes to the class that has received the smallest share of the disk relative to its
+ * weight (stride scheduling), so that every class makes progress in proportion to its weight. Background classes are
+ * additionally held to background_io_rate_limit pages per second by a token bucket that saves up to
+ * BACKGROUND_IO_BURST pages.
+ *
+ * The I/O itself runs on the calling thread once it is admitted, so the scheduler adds no thread hop to a read.
+ */
+class IoScheduler {
+ public:
+  static constexpr size_t NUM_IO_CLASSES = 4;
+
+  /**
+   * Create a new IoScheduler.
+   * @param max_in_flight number of I/Os that may run at once
+   */
+  explicit IoScheduler(size_t max_in_flight = IO_SCHEDULER_DEPTH);
+
+  DISALLOW_COPY_AND_MOVE(IoScheduler);
+
+  /**
+   * Run an I/O once the scheduler admits it. Blocks until it is done.
+   * @param io_class the class of the I/O
+   * @param num_pages number of pages the I/O transfers, which is what the rate limit counts
+   * @param io the I/O
+   */
+  void Run(IoClass io_class, size_t num_pages, const std::function<void()> &io);
+
+  /**
+   * Set the weight of a class: while several classes wait, each gets a share of the disk proportional to its weight.
+   * @param io_class the class
+   * @param weight the weight, at least 1
+   */
+  void SetWeight(IoClass io_class, uint32_t weight);
+
+  /** @return the statistics of a class */
+  auto GetStats(IoClass io_class) -> IoClassStats;
+
+  /** @return a human readable summary of the statistics of all classes */
+  auto ToString() -> std::string;
+
+  /** @return true if the class is throttled by the rate limit */
+  static auto IsBackground(IoClass io_class) -> bool {
+    return io_class == IoClass::PREFETCH || io_class == IoClass::WRITE_BACK;
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  /** An I/O waiting to be admitted, on the stack of its thread. */
+  struct Waiter {
+    size_t num_pages_;
+    bool admitted_ = false;
+    std::condition_variable cv_;
+  };
+
+  struct ClassQueue {
+    std::deque<Waiter *> waiters_;
+    uint32_t weight_ = 1;
+    /** Virtual time of the class; the class with the smallest one goes next. */
+    uint64_t pass_ = 0;
+    IoClassStats stats_;
+  };
+
+  /** Admit waiting I/Os while there are free slots. Requires the latch. */
+  void Dispatch();
+
+  /** Add the tokens earned since the last refill. Requires the latch. */
+  void RefillTokens(Clock::time_point now);
+
+  /** @return true if the bucket holds enough tokens for an I/O of a background class. Requires the latch. */
+  auto HasTokens(size_t num_pages) const -> bool;
+
+  const size_t max_in_flight_;
+  std::mutex latch_;
+  size_t in_flight_ = 0;
+  ClassQueue queues_[NUM_IO_CLASSES];
+  /** Virtual time of the last admitted I/O; a class that was idle starts from it instead of from its own past. */
+  uint64_t global_pass_ = 0;
+  /** Token bucket of the background classes, in pages. May go negative after an I/O larger than the burst. */
+  double tokens_ = BACKGROUND_IO_BURST;
+  Clock::time_point last_refill_ = Clock::now();
+};
+
+}  // namespace bustub
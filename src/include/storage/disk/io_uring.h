@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring.h
+//
+// Identification: src/include/storage/disk/io_uring.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <functional>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * IoUring runs reads and writes of one file asynchronously through a Linux io_uring. It talks to the kernel with the
+ * raw system calls, so it needs no library.
+ *
+ * Submit() fills the submission queue with a whole batch of requests and hands it to the kernel with a single system
+ * call. A completion thread reaps the completion queue and calls the callback of every finished request. Buffers
+ * registered with RegisterBuffers() are read and written with the fixed buffer operations, which spares the kernel
+ * mapping them on every request.
+ */
+class IoUring {
+ public:
+  /**
+   * A read or write of the file.
+   */
+  struct Request {
+    /** True to write data_ to the file, false to read into it. */
+    bool is_write_;
+    /** Offset in the file. */
+    off_t offset_;
+    char *data_;
+    size_t size_;
+    /** Called from the completion thread with the number of bytes transferred, or -errno. */
+    std::function<void(ssize_t)> callback_;
+  };
+
+  /**
+   * Set up a ring for a file.
+   * @param fd the file descriptor of the file
+   * @param queue_depth the maximum number of requests in flight
+   * @return the ring, or nullptr if io_uring is not available on this system
+   */
+  static auto Create(int fd, unsigned queue_depth) -> IoUring *;
+
+  /**
+   * Waits for the requests in flight, stops the completion thread and tears down the ring.
+   */
+  ~IoUring();
+
+  DISALLOW_COPY_AND_MOVE(IoUring);
+
+  /**
+   * Start a batch of requests. Blocks while the ring is full, until enough requests in flight complete.
+   * @param requests the requests; their callbacks are moved out
+   * @param num_requests number of requests
+   */
+  void Submit(Request *requests, size_t num_requests);
+
+  /**
+   * Replace the set of fixed buffers. Waits until no request is in flight, since requests in flight may use the old
+   * set. Registered memory stays pinned until it is unregistered.
+   * @param buffers the buffers, an empty set unregisters all of them
+   * @return true if the kernel accepted the buffers, false if they are used like any other memory
+   */
+  auto RegisterBuffers(const std::vector<iovec> &buffers) -> bool;
+
+ private:
+  IoUring() = default;
+
+  /** State of a request from submission to completion. */
+  struct InFlight {
+    iovec iov_;
+    std::function<void(ssize_t)> callback_;
+  };
+
+  /** Reap completions until the shutdown marker arrives. */
+  void RunCompletions();
+
+  /** @return the index of the fixed buffer holding [data, data + size), or -1 */
+  auto FindFixedBuffer(const char *data, size_t size) const -> int;
+
+  int fd_ = -1;
+  int ring_fd_ = -1;
+  unsigned queue_depth_ = 0;
+
+  void *sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void *cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  void *sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  unsigned *sq_tail_ = nullptr;
+  unsigned *sq_mask_ = nullptr;
+  unsigned *sq_array_ = nullptr;
+  unsigned *cq_head_ = nullptr;
+  unsigned *cq_tail_ = nullptr;
+  unsigned *cq_mask_ = nullptr;
+  void *cqes_ = nullptr;
+
+  /** Serializes submissions, and protects in_flight_ and fixed_buffers_. */
+  std::mutex latch_;
+  std::condition_variable completed_cv_;
+  /** Requests submitted and not completed yet, at most queue_depth_. */
+  size_t in_flight_ = 0;
+  std::vector<iovec> fixed_buffers_;
+  std::thread *completion_thread_ = nullptr;
+};
+
+}  // namespace bustub
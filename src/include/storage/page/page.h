@@ -12,8 +12,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <memory>
 
 #include "common/config.h"
 #include "common/rwlatch.h"
@@ -24,14 +26,17 @@ namespace bustub {
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The pages of a buffer pool only hold a pointer to their data, which lives in the pool's frame arena. This keeps
+ * the book-keeping of a frame on cache lines of its own, away from both the page bytes and the other frames.
  */
-class Page {
+class alignas(CACHE_LINE_SIZE) Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManagerInstance;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. Allocates zeroed page data owned by the page. */
+  Page() : owned_data_(new char[PAGE_SIZE]), data_(owned_data_.get()) { ResetMemory(); }
 
   /** Default destructor. */
   ~Page() = default;
@@ -43,16 +48,27 @@ class Page {
   inline auto GetPageId() -> page_id_t { return page_id_; }
 
   /** @return the pin count of this page */
-  inline auto GetPinCount() -> int { return pin_count_; }
+  inline auto GetPinCount() -> int {
+    int pin_count = pin_count_;
+    return pin_count < 0 ? 0 : pin_count;
+  }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline auto IsDirty() -> bool { return is_dirty_; }
 
   /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  inline void WLatch() {
+    rwlatch_.WLock();
+    // An odd version tells optimistic readers that the page is being modified.
+    version_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -60,6 +76,22 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * Start an optimistic read of the page, which takes neither a pin nor the page latch.
+   * @return the current version of the page; odd while a writer holds the write latch
+   */
+  inline auto ReadVersion() -> uint64_t { return version_.load(std::memory_order_acquire); }
+
+  /**
+   * Finish an optimistic read of the page.
+   * @param version the version returned by ReadVersion when the read started
+   * @return true if the page was neither modified nor replaced since then, i.e. the data read is consistent
+   */
+  inline auto ValidateVersion(uint64_t version) -> bool {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -75,17 +107,40 @@ class Page {
   static constexpr size_t OFFSET_LSN = 4;
 
  private:
+  /**
+   * Constructor for the frames of a buffer pool.
+   * @param data the zeroed frame memory holding the page data, owned by the buffer pool
+   */
+  explicit Page(char *data) : data_(data) {}
+
+  /** Invalidate optimistic reads of the frame before it is reused for another page. */
+  inline void BumpVersion() {
+    version_.fetch_add(2, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
+  /** The page data, if the page is not part of a buffer pool. */
+  std::unique_ptr<char[]> owned_data_;
   /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
+  char *data_;
+  // The book-keeping fields are atomic because the buffer pool pins and unpins resident pages without its latch.
   /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  std::atomic<page_id_t> page_id_ = INVALID_PAGE_ID;
+  /** The pin count of this page, -1 while the frame is free or being evicted. */
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
+  /** True while the frame is being read from or written to disk without the buffer pool latch held. */
+  std::atomic<bool> io_in_progress_ = false;
+  /** True if the page was read ahead and has not been fetched since. */
+  std::atomic<bool> read_ahead_ = false;
+  /** Set by optimistic reads, which leave the replacer alone; the frame gets a second chance when picked as victim. */
+  std::atomic<bool> referenced_ = false;
+  /** Bumped by writers and whenever the frame is reused, to validate optimistic reads. */
+  std::atomic<uint64_t> version_{0};
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
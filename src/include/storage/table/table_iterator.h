@@ -14,6 +14,7 @@
 
 #include <cassert>
 
+#include "buffer/buffer_access_strategy.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 #include "storage/table/tuple.h"
@@ -21,6 +22,7 @@
 namespace bustub {
 
 class TableHeap;
+class TablePage;
 
 /**
  * TableIterator enables the sequential scan of a TableHeap.
@@ -29,10 +31,22 @@ class TableIterator {
   friend class Cursor;
 
  public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  /**
+   * Create a TableIterator.
+   * @param table_heap the table heap to iterate over
+   * @param rid the rid to start at
+   * @param txn the transaction performing the scan
+   * @param strategy the buffer access strategy used to read pages, nullptr to use the buffer pool normally
+   */
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        strategy_(other.strategy_),
+        read_ahead_page_(other.read_ahead_page_),
+        read_ahead_depth_(other.read_ahead_depth_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -54,13 +68,28 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    strategy_ = other.strategy_;
+    read_ahead_page_ = other.read_ahead_page_;
+    read_ahead_depth_ = other.read_ahead_depth_;
     return *this;
   }
 
  private:
+  /**
+   * Ask the buffer pool to read ahead the pages that follow the cursor, up to scan_prefetch_window pages.
+   * @param page the page the cursor is on, read latched
+   * @param advanced true if the cursor just moved onto this page
+   */
+  void ReadAhead(TablePage *page, bool advanced);
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  BufferAccessStrategy *strategy_;
+  /** The furthest page read ahead so far, INVALID_PAGE_ID before the first page is visited. */
+  page_id_t read_ahead_page_{INVALID_PAGE_ID};
+  /** How many pages read_ahead_page_ is ahead of the cursor. */
+  size_t read_ahead_depth_{0};
 };
 
 }  // namespace bustub
@@ -10,13 +10,20 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
-#include <mutex>  // NOLINT
+#include <memory>
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -26,12 +33,115 @@ namespace bustub {
 
 static char *buffer_used;
 
+/**
+ * Write a whole buffer at an offset, resuming after interrupts and short writes
+ * @return: false on an I/O error
+ */
+static auto PwriteFully(int fd, const char *data, size_t size, off_t offset) -> bool {
+  while (size > 0) {
+    ssize_t written = pwrite(fd, data, size, offset);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += written;
+    size -= written;
+    offset += written;
+  }
+  return true;
+}
+
+/**
+ * Read a whole buffer at an offset, resuming after interrupts and short reads
+ * @return: the number of bytes read, less than size only at the end of the file, or -1 on an I/O error
+ */
+static auto PreadFully(int fd, char *data, size_t size, off_t offset) -> ssize_t {
+  size_t total = 0;
+  while (total < size) {
+    ssize_t read_count = pread(fd, data + total, size - total, offset + total);
+    if (read_count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    if (read_count == 0) {
+      break;
+    }
+    total += read_count;
+  }
+  return total;
+}
+
+/**
+ * Write a list of buffers at an offset, like PwriteFully()
+ * @return: false on an I/O error
+ */
+static auto PwritevFully(int fd, std::vector<iovec> iov, off_t offset) -> bool {
+  iovec *next = iov.data();
+  size_t remaining = iov.size();
+  while (remaining > 0) {
+    ssize_t written = pwritev(fd, next, static_cast<int>(std::min<size_t>(remaining, IOV_MAX)), offset);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    offset += written;
+    for (; remaining > 0 && static_cast<size_t>(written) >= next->iov_len; ++next, --remaining) {
+      written -= next->iov_len;
+    }
+    if (written > 0) {
+      next->iov_base = static_cast<char *>(next->iov_base) + written;
+      next->iov_len -= written;
+    }
+  }
+  return true;
+}
+
+/**
+ * Read a list of buffers at an offset, like PreadFully()
+ * @return: the number of bytes read, less than the buffers hold only at the end of the file, or -1 on an I/O error
+ */
+static auto PreadvFully(int fd, std::vector<iovec> iov, off_t offset) -> ssize_t {
+  iovec *next = iov.data();
+  size_t remaining = iov.size();
+  ssize_t total = 0;
+  while (remaining > 0) {
+    ssize_t read_count = preadv(fd, next, static_cast<int>(std::min<size_t>(remaining, IOV_MAX)), offset + total);
+    if (read_count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    if (read_count == 0) {
+      break;
+    }
+    total += read_count;
+    for (; remaining > 0 && static_cast<size_t>(read_count) >= next->iov_len; ++next, --remaining) {
+      read_count -= next->iov_len;
+    }
+    if (read_count > 0) {
+      next->iov_base = static_cast<char *>(next->iov_base) + read_count;
+      next->iov_len -= read_count;
+    }
+  }
+  return total;
+}
+
+static auto IsAligned(const char *data) -> bool {
+  return reinterpret_cast<uintptr_t>(data) % DIRECT_IO_ALIGNMENT == 0;
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -53,82 +163,421 @@ DiskManager::DiskManager(const std::string &db_file)
     }
   }
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
-    }
+  int flags = O_RDWR | O_CREAT;
+  if (enable_direct_io) {
+    db_fd_ = open(db_file.c_str(), flags | O_DIRECT, 0644);
+    direct_io_ = db_fd_ >= 0;
+  }
+  if (db_fd_ < 0) {
+    // direct I/O is not supported everywhere, e.g. not on tmpfs
+    db_fd_ = open(db_file.c_str(), flags, 0644);
+  }
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) == 0) {
+    db_file_size_ = stat_buf.st_size;
   }
   buffer_used = nullptr;
 }
 
+DiskManager::DiskManager() = default;
+
+DiskManager::~DiskManager() {
+  DetachClients();
+  StopAsyncIo();
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+  }
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+  DetachClients();
+  StopAsyncIo();
+  Sync();
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+    db_fd_ = -1;
   }
   log_io_.close();
 }
 
+void DiskManager::AddClient(DiskManagerClient *client) {
+  std::scoped_lock clients_latch(clients_latch_);
+  clients_.push_back(client);
+}
+
+void DiskManager::RemoveClient(DiskManagerClient *client) {
+  std::scoped_lock clients_latch(clients_latch_);
+  clients_.erase(std::remove(clients_.begin(), clients_.end(), client), clients_.end());
+}
+
+void DiskManager::DetachClients() {
+  std::vector<DiskManagerClient *> clients;
+  {
+    std::scoped_lock clients_latch(clients_latch_);
+    clients.swap(clients_);
+  }
+  // The clients write back through this disk manager, so they are detached without the latch.
+  for (auto *client : clients) {
+    client->DetachDiskManager();
+  }
+}
+
+/**
+ * Make the writes to the db file durable
+ */
+void DiskManager::Sync() {
+  if (db_fd_ < 0 || !unsynced_writes_.exchange(false)) {
+    return;
+  }
+  if (fdatasync(db_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing");
+  }
+}
+
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
+  WritePageAt(page_id, page_data);
+}
+
+/**
+ * Write the contents of consecutive pages into disk file
+ */
+auto DiskManager::WritePages(page_id_t first_page_id, const char *const *pages_data, size_t num_pages) -> bool {
+  num_writes_ += num_pages;
+  // The data is only read; the cast lets reads and writes share one implementation.
+  if (!TransferPagesAt(true, first_page_id, const_cast<char *const *>(pages_data), num_pages)) {
+    LOG_DEBUG("I/O error while writing");
+    return false;
+  }
+  return true;
+}
+
+auto DiskManager::WritePageAt(page_id_t page_id, const char *page_data) -> bool {
+  off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+  char *bounce = nullptr;
+  if (direct_io_ && !IsAligned(page_data)) {
+    bounce = static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, PAGE_SIZE));
+    memcpy(bounce, page_data, PAGE_SIZE);
+    page_data = bounce;
+  }
+  bool written = PwriteFully(db_fd_, page_data, PAGE_SIZE, offset);
+  free(bounce);
   // check for I/O error
-  if (db_io_.bad()) {
+  if (!written) {
     LOG_DEBUG("I/O error while writing");
-    return;
+    return false;
+  }
+  NoteWrite(page_id);
+  return true;
+}
+
+void DiskManager::NoteWrite(page_id_t page_id) {
+  unsynced_writes_ = true;
+  int64_t end = (static_cast<int64_t>(page_id) + 1) * PAGE_SIZE;
+  int64_t size = db_file_size_.load();
+  while (size < end && !db_file_size_.compare_exchange_weak(size, end)) {
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
-void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * PAGE_SIZE;
+void DiskManager::ReadPage(page_id_t page_id, char *page_data) { ReadPageAt(page_id, page_data); }
+
+auto DiskManager::ReadPageAt(page_id_t page_id, char *page_data) -> bool {
+  off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (offset > db_file_size_.load()) {
     LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
+    return false;
+  }
+  char *buffer = page_data;
+  if (direct_io_ && !IsAligned(page_data)) {
+    buffer = static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, PAGE_SIZE));
+  }
+  ssize_t read_count = PreadFully(db_fd_, buffer, PAGE_SIZE, offset);
+  if (buffer != page_data) {
+    if (read_count > 0) {
+      memcpy(page_data, buffer, read_count);
+    }
+    free(buffer);
+  }
+  if (read_count < 0) {
+    LOG_DEBUG("I/O error while reading");
+    return false;
+  }
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+  }
+  return true;
+}
+
+/**
+ * Read the contents of consecutive pages into the given memory areas
+ */
+void DiskManager::ReadPages(page_id_t first_page_id, char *const *pages_data, size_t num_pages) {
+  // check if read beyond file length
+  if (static_cast<off_t>(first_page_id) * PAGE_SIZE > db_file_size_.load()) {
+    LOG_DEBUG("I/O error reading past end of file");
+    for (size_t i = 0; i < num_pages; ++i) {
+      memset(pages_data[i], 0, PAGE_SIZE);
+    }
+    return;
+  }
+  if (!TransferPagesAt(false, first_page_id, pages_data, num_pages)) {
+    LOG_DEBUG("I/O error while reading");
+  }
+}
+
+auto DiskManager::TransferPagesAt(bool is_write, page_id_t first_page_id, char *const *pages_data, size_t num_pages)
+    -> bool {
+  size_t num_unaligned = 0;
+  if (direct_io_) {
+    num_unaligned = std::count_if(pages_data, pages_data + num_pages, [](char *data) { return !IsAligned(data); });
+  }
+  char *bounce = nullptr;
+  if (num_unaligned > 0) {
+    bounce = static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, num_unaligned * PAGE_SIZE));
+  }
+  std::vector<iovec> iov(num_pages);
+  for (size_t i = 0, next_bounce = 0; i < num_pages; ++i) {
+    char *data = pages_data[i];
+    if (bounce != nullptr && !IsAligned(data)) {
+      data = bounce + next_bounce++ * PAGE_SIZE;
+      if (is_write) {
+        memcpy(data, pages_data[i], PAGE_SIZE);
+      }
+    }
+    iov[i] = {data, PAGE_SIZE};
+  }
+
+  off_t offset = static_cast<off_t>(first_page_id) * PAGE_SIZE;
+  bool done;
+  if (is_write) {
+    done = PwritevFully(db_fd_, iov, offset);
+    if (done) {
+      NoteWrite(first_page_id + static_cast<page_id_t>(num_pages) - 1);
+    }
   } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
+    ssize_t read_count = PreadvFully(db_fd_, iov, offset);
+    done = read_count >= 0;
+    // zero what lies beyond the end of the file, then copy out of the aligned buffers
+    size_t valid = std::max<ssize_t>(read_count, 0);
+    for (size_t i = 0; i < num_pages; ++i) {
+      size_t begin = i * PAGE_SIZE;
+      auto *data = static_cast<char *>(iov[i].iov_base);
+      if (valid < begin + PAGE_SIZE) {
+        size_t kept = valid > begin ? valid - begin : 0;
+        memset(data + kept, 0, PAGE_SIZE - kept);
+      }
+      if (data != pages_data[i]) {
+        memcpy(pages_data[i], data, PAGE_SIZE);
+      }
+    }
+  }
+  free(bounce);
+  return done;
+}
+
+/**
+ * Start asynchronous reads and writes of pages
+ */
+void DiskManager::SubmitRequests(DiskRequest *requests, size_t num_requests) {
+  std::shared_lock submit_latch(submit_latch_);
+  if (async_stopped_) {
+    // shut down, like synchronous I/O on the closed file
+    for (size_t i = 0; i < num_requests; ++i) {
+      requests[i].callback_(false);
+    }
+    return;
+  }
+  if (!async_started_) {
+    std::scoped_lock async_latch(async_latch_);
+    StartAsyncIo();
+  }
+  std::vector<IoUring::Request> ring_requests;
+  for (size_t i = 0; i < num_requests; ++i) {
+    DiskRequest &request = requests[i];
+    off_t offset = static_cast<off_t>(request.page_id_) * PAGE_SIZE;
+    if (request.is_write_) {
+      num_writes_ += 1;
+    } else if (offset > db_file_size_.load()) {
+      LOG_DEBUG("I/O error reading past end of file");
+      request.callback_(false);
+      continue;
+    }
+    if (io_uring_ == nullptr) {
+      {
+        std::scoped_lock async_latch(async_latch_);
+        io_queue_.push_back(std::move(request));
+      }
+      io_queue_cv_.notify_one();
+      continue;
+    }
+    if (direct_io_ && !IsAligned(request.data_)) {
+      // Direct I/O needs aligned memory, which only the synchronous path provides.
+      bool done = request.is_write_ ? WritePageAt(request.page_id_, request.data_)
+                                    : ReadPageAt(request.page_id_, request.data_);
+      request.callback_(done);
+      continue;
+    }
+    auto *pending = new DiskRequest(std::move(request));
+    auto complete = [this, pending](ssize_t result) {
+      CompleteRequest(pending, result);
+      delete pending;
+    };
+    ring_requests.push_back({pending->is_write_, offset, pending->data_, PAGE_SIZE, std::move(complete)});
+  }
+  if (!ring_requests.empty()) {
+    io_uring_->Submit(ring_requests.data(), ring_requests.size());
+  }
+}
+
+void DiskManager::ReadPageAsync(page_id_t page_id, char *page_data, DiskCallback callback) {
+  DiskRequest request{false, page_id, page_data, std::move(callback)};
+  SubmitRequests(&request, 1);
+}
+
+void DiskManager::WritePageAsync(page_id_t page_id, const char *page_data, DiskCallback callback) {
+  // The data is only read; the request type shares the buffer field with reads.
+  DiskRequest request{true, page_id, const_cast<char *>(page_data), std::move(callback)};
+  SubmitRequests(&request, 1);
+}
+
+auto DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<bool> {
+  auto promise = std::make_shared<std::promise<bool>>();
+  ReadPageAsync(page_id, page_data, [promise](bool done) { promise->set_value(done); });
+  return promise->get_future();
+}
+
+auto DiskManager::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<bool> {
+  auto promise = std::make_shared<std::promise<bool>>();
+  WritePageAsync(page_id, page_data, [promise](bool done) { promise->set_value(done); });
+  return promise->get_future();
+}
+
+void DiskManager::CompleteRequest(DiskRequest *request, ssize_t result) {
+  bool done = result >= 0 && (!request->is_write_ || result == PAGE_SIZE);
+  if (!done) {
+    LOG_DEBUG("I/O error in asynchronous %s", request->is_write_ ? "write" : "read");
+  } else if (request->is_write_) {
+    NoteWrite(request->page_id_);
+  } else if (result < PAGE_SIZE) {
+    // the file ends before the end of the page
+    memset(request->data_ + result, 0, PAGE_SIZE - result);
+  }
+  request->callback_(done);
+}
+
+void DiskManager::RunIoWorker() {
+  std::unique_lock<std::mutex> async_latch(async_latch_);
+  while (true) {
+    io_queue_cv_.wait(async_latch, [&] { return async_stopped_ || !io_queue_.empty(); });
+    if (io_queue_.empty()) {
+      break;
+    }
+    DiskRequest request = std::move(io_queue_.front());
+    io_queue_.pop_front();
+    async_latch.unlock();
+    bool done = request.is_write_ ? WritePageAt(request.page_id_, request.data_)
+                                  : ReadPageAt(request.page_id_, request.data_);
+    request.callback_(done);
+    async_latch.lock();
+  }
+}
+
+void DiskManager::StartAsyncIo() {
+  if (async_started_) {
+    return;
+  }
+  BUSTUB_ASSERT(!async_stopped_, "the disk manager was shut down");
+  // Without a file, e.g. in a subclass, the thread pool serves the requests through the virtual page I/O.
+  if (enable_io_uring && db_fd_ >= 0) {
+    io_uring_ = IoUring::Create(db_fd_, ASYNC_IO_QUEUE_DEPTH);
+  }
+  if (io_uring_ == nullptr) {
+    for (int i = 0; i < ASYNC_IO_THREADS; ++i) {
+      io_workers_.emplace_back(&DiskManager::RunIoWorker, this);
+    }
+  }
+  async_started_ = true;
+}
+
+void DiskManager::StopAsyncIo() {
+  {
+    // Wait for the submissions in progress; later ones fail right away.
+    std::unique_lock submit_latch(submit_latch_);
+    std::scoped_lock async_latch(async_latch_);
+    if (async_stopped_) {
       return;
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    async_stopped_ = true;
+  }
+  // Both backends finish the requests already submitted before they stop.
+  io_queue_cv_.notify_all();
+  for (auto &worker : io_workers_) {
+    worker.join();
+  }
+  io_workers_.clear();
+  std::scoped_lock async_latch(async_latch_);
+  delete io_uring_;
+  io_uring_ = nullptr;
+  registered_buffers_.clear();
+}
+
+auto DiskManager::RegisterBuffers(char *base, size_t size) -> bool {
+  std::scoped_lock async_latch(async_latch_);
+  if (async_stopped_) {
+    return false;
+  }
+  StartAsyncIo();
+  if (io_uring_ == nullptr) {
+    return false;
+  }
+  registered_buffers_.push_back({base, size});
+  if (io_uring_->RegisterBuffers(registered_buffers_)) {
+    return true;
+  }
+  // The kernel refused, e.g. beyond the limit of locked memory; keep the buffers registered before.
+  registered_buffers_.pop_back();
+  io_uring_->RegisterBuffers(registered_buffers_);
+  return false;
+}
+
+void DiskManager::UnregisterBuffers(char *base) {
+  std::scoped_lock async_latch(async_latch_);
+  if (io_uring_ == nullptr) {
+    return;
+  }
+  for (auto it = registered_buffers_.begin(); it != registered_buffers_.end(); ++it) {
+    if (it->iov_base == base) {
+      registered_buffers_.erase(it);
+      io_uring_->RegisterBuffers(registered_buffers_);
+      return;
     }
   }
 }
 
+auto DiskManager::IsIoUring() -> bool {
+  std::scoped_lock async_latch(async_latch_);
+  if (async_stopped_) {
+    return false;
+  }
+  StartAsyncIo();
+  return io_uring_ != nullptr;
+}
+
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
@@ -199,7 +648,7 @@ auto DiskManager::GetNumFlushes() const -> int { return num_flushes_; }
 /**
  * Returns number of Writes made so far
  */
-auto DiskManager::GetNumWrites() const -> int { return num_writes_; }
+auto DiskManager::GetNumWrites() const -> int { return num_writes_.load(); }
 
 /**
  * Returns true if the log is currently being flushed
@@ -0,0 +1,181 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_memory.cpp
+//
+// Identification: src/storage/disk/disk_manager_memory.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_memory.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <thread>  // NOLINT
+
+#include "common/logger.h"
+
+namespace bustub {
+
+auto DiskLatencyModel::Nvme() -> DiskLatencyModel {
+  using std::chrono::microseconds;
+  DiskLatencyModel model;
+  model.read_ = {LatencyDistribution::Kind::EXPONENTIAL, microseconds(70), microseconds(20)};
+  model.write_ = {LatencyDistribution::Kind::EXPONENTIAL, microseconds(20), microseconds(10)};
+  model.sync_ = {LatencyDistribution::Kind::EXPONENTIAL, microseconds(200), microseconds(100)};
+  model.bandwidth_ = static_cast<size_t>(2) << 30;
+  model.concurrency_ = 32;
+  return model;
+}
+
+auto DiskLatencyModel::Hdd() -> DiskLatencyModel {
+  using std::chrono::microseconds;
+  DiskLatencyModel model;
+  // A seek plus up to a full rotation of a 7200 rpm disk.
+  model.read_ = {LatencyDistribution::Kind::UNIFORM, microseconds(4000), microseconds(8300)};
+  model.write_ = {LatencyDistribution::Kind::UNIFORM, microseconds(4000), microseconds(8300)};
+  model.sync_ = {LatencyDistribution::Kind::UNIFORM, microseconds(8000), microseconds(8300)};
+  model.bandwidth_ = 200 << 20;
+  model.concurrency_ = 1;
+  return model;
+}
+
+DiskManagerMemory::DiskManagerMemory(const DiskLatencyModel &latency) : latency_(latency) {}
+
+DiskManagerMemory::~DiskManagerMemory() {
+  // The clients write back, and the asynchronous requests still in flight use, the pages of this object.
+  DetachClients();
+  StopAsyncIo();
+}
+
+void DiskManagerMemory::Sync() {
+  if (unsynced_writes_.exchange(false)) {
+    Delay(latency_.sync_);
+  }
+}
+
+void DiskManagerMemory::WriteLog(char *log_data, int size) {
+  if (size == 0) {  // no effect on num_flushes_ if log buffer is empty
+    return;
+  }
+  flush_log_ = true;
+  if (flush_log_f_ != nullptr) {
+    // used for checking non-blocking flushing
+    BUSTUB_ASSERT(flush_log_f_->wait_for(std::chrono::seconds(10)) == std::future_status::ready, "flush timed out");
+  }
+  num_flushes_ += 1;
+  // a sequential write that is only done once it is durable
+  Delay(latency_.write_, size);
+  Delay(latency_.sync_);
+  {
+    std::scoped_lock latch(log_latch_);
+    log_.append(log_data, size);
+  }
+  flush_log_ = false;
+}
+
+auto DiskManagerMemory::ReadLog(char *log_data, int size, int offset) -> bool {
+  std::scoped_lock latch(log_latch_);
+  if (offset < 0 || static_cast<size_t>(offset) >= log_.size()) {
+    return false;
+  }
+  size_t read_count = std::min(log_.size() - offset, static_cast<size_t>(size));
+  memcpy(log_data, log_.data() + offset, read_count);
+  memset(log_data + read_count, 0, size - read_count);
+  return true;
+}
+
+auto DiskManagerMemory::WritePageAt(page_id_t page_id, const char *page_data) -> bool {
+  return TransferPagesAt(true, page_id, const_cast<char *const *>(&page_data), 1);
+}
+
+auto DiskManagerMemory::ReadPageAt(page_id_t page_id, char *page_data) -> bool {
+  // check if read beyond file length
+  if (page_id < 0 || static_cast<int64_t>(page_id) * PAGE_SIZE > db_file_size_.load()) {
+    LOG_DEBUG("I/O error reading past end of file");
+    return false;
+  }
+  return TransferPagesAt(false, page_id, &page_data, 1);
+}
+
+auto DiskManagerMemory::TransferPagesAt(bool is_write, page_id_t first_page_id, char *const *pages_data,
+                                        size_t num_pages) -> bool {
+  if (first_page_id < 0) {
+    return false;
+  }
+  Delay(is_write ? latency_.write_ : latency_.read_, num_pages * PAGE_SIZE);
+  for (size_t i = 0; i < num_pages; ++i) {
+    auto page_id = first_page_id + static_cast<page_id_t>(i);
+    char *data;
+    {
+      std::shared_lock latch(chunks_latch_);
+      data = PageData(page_id);
+    }
+    if (data == nullptr && is_write) {
+      std::scoped_lock latch(chunks_latch_);
+      size_t chunk = page_id / CHUNK_PAGES;
+      if (chunk >= chunks_.size()) {
+        chunks_.resize(chunk + 1);
+      }
+      if (chunks_[chunk] == nullptr) {
+        // Pages never written read as zeros, like a hole in a file.
+        chunks_[chunk].reset(new char[CHUNK_PAGES * PAGE_SIZE]());
+      }
+      data = PageData(page_id);
+    }
+    // Chunks never move, so the page is copied without the latch.
+    if (is_write) {
+      memcpy(data, pages_data[i], PAGE_SIZE);
+    } else if (data != nullptr) {
+      memcpy(pages_data[i], data, PAGE_SIZE);
+    } else {
+      memset(pages_data[i], 0, PAGE_SIZE);
+    }
+  }
+  if (is_write) {
+    NoteWrite(first_page_id + static_cast<page_id_t>(num_pages) - 1);
+  }
+  return true;
+}
+
+void DiskManagerMemory::Delay(const LatencyDistribution &latency, size_t num_bytes) {
+  double transfer_us = latency_.bandwidth_ == 0 ? 0 : static_cast<double>(num_bytes) * 1e6 / latency_.bandwidth_;
+  if (latency.base_.count() == 0 && latency.jitter_.count() == 0 && transfer_us == 0) {
+    return;
+  }
+  // Every thread draws the same sequence, so that runs are repeatable.
+  thread_local std::mt19937 rng(15445);
+  auto jitter = static_cast<double>(latency.jitter_.count());
+  double delay_us = static_cast<double>(latency.base_.count()) + transfer_us;
+  if (jitter > 0 && latency.kind_ == LatencyDistribution::Kind::UNIFORM) {
+    delay_us += std::uniform_real_distribution<double>(0, jitter)(rng);
+  } else if (jitter > 0 && latency.kind_ == LatencyDistribution::Kind::EXPONENTIAL) {
+    delay_us += std::exponential_distribution<double>(1 / jitter)(rng);
+  }
+
+  if (latency_.concurrency_ > 0) {
+    std::unique_lock<std::mutex> latch(channel_latch_);
+    channel_cv_.wait(latch, [&] { return busy_channels_ < latency_.concurrency_; });
+    busy_channels_++;
+  }
+  std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(delay_us)));
+  if (latency_.concurrency_ > 0) {
+    std::scoped_lock latch(channel_latch_);
+    busy_channels_--;
+    channel_cv_.notify_one();
+  }
+}
+
+auto DiskManagerMemory::PageData(page_id_t page_id) const -> char * {
+  size_t chunk = page_id / CHUNK_PAGES;
+  if (chunk >= chunks_.size() || chunks_[chunk] == nullptr) {
+    return nullptr;
+  }
+  return chunks_[chunk].get() + page_id % CHUNK_PAGES * PAGE_SIZE;
+}
+
+}  // namespace bustub
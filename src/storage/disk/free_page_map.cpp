@@ -0,0 +1,188 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_map.cpp
+//
+// Identification: src/storage/disk/free_page_map.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/free_page_map.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace bustub {
+
+namespace {
+
+/** Layout of the header of a map page. */
+struct MapPageHeader {
+  uint32_t magic_;
+  uint32_t instance_index_;
+  uint32_t extent_;
+  uint32_t allocated_;
+};
+
+}  // namespace
+
+static_assert(sizeof(MapPageHeader) == FreePageMap::HEADER_SIZE, "map page header size mismatch");
+static_assert(FreePageMap::EXTENT_SIZE % 64 == 0, "an extent must fill whole words of the bitmap");
+
+FreePageMap::FreePageMap(DiskManager *disk_manager, uint32_t num_instances, uint32_t instance_index)
+    : disk_manager_(disk_manager), num_instances_(num_instances), instance_index_(instance_index) {
+  auto file_pages = static_cast<size_t>((disk_manager_->GetDbFileSize() + PAGE_SIZE - 1) / PAGE_SIZE);
+  if (file_pages > instance_index_) {
+    next_local_ = (file_pages - instance_index_ + num_instances_ - 1) / num_instances_;
+  }
+
+  char data[PAGE_SIZE];
+  MapPageHeader header;
+  // Only extents whose map page lies within the file can have one.
+  for (size_t extent = 0; (extent + 1) * EXTENT_SIZE <= next_local_; ++extent) {
+    disk_manager_->ReadPage(MapPageId(extent), data);
+    memcpy(&header, data, sizeof(header));
+    // A map page never written reads as zeros, or whatever a hole in the file holds.
+    if (header.magic_ != MAGIC || header.instance_index_ != instance_index_ || header.extent_ != extent ||
+        header.allocated_ >= EXTENT_SIZE) {
+      continue;
+    }
+    extents_.resize(extent + 1);
+    Extent &map = extents_[extent];
+    memcpy(map.bits_.data(), data + HEADER_SIZE, WORDS_PER_EXTENT * sizeof(uint64_t));
+    map.on_disk_ = true;
+    map.allocated_ = header.allocated_;
+    // Nothing beyond the allocation mark is free, and the map page itself never is.
+    for (size_t i = map.allocated_; i < EXTENT_SIZE; ++i) {
+      map.bits_[i / 64] &= ~(static_cast<uint64_t>(1) << (i % 64));
+    }
+    for (auto word : map.bits_) {
+      map.num_free_ += __builtin_popcountll(word);
+    }
+    num_free_ += map.num_free_;
+    // The map page ends the file: the extent was allocated up to its mark, not up to the map page.
+    if ((extent + 1) * EXTENT_SIZE == next_local_) {
+      next_local_ = extent * EXTENT_SIZE + map.allocated_;
+    }
+  }
+}
+
+auto FreePageMap::Allocate(bool *reused) -> page_id_t {
+  std::scoped_lock latch(latch_);
+  if (num_free_ > 0) {
+    size_t local = FindFree(cursor_);
+    if (local == SIZE_MAX) {
+      local = FindFree(0);
+    }
+    Extent &map = extents_[local / EXTENT_SIZE];
+    map.bits_[local % EXTENT_SIZE / 64] &= ~(static_cast<uint64_t>(1) << (local % 64));
+    map.num_free_--;
+    map.dirty_ = true;
+    num_free_--;
+    cursor_ = local + 1;
+    allocations_unwritten_ = true;
+    *reused = true;
+    return ToPageId(local);
+  }
+
+  if (next_local_ % EXTENT_SIZE == EXTENT_SIZE - 1) {
+    next_local_++;
+  }
+  size_t extent = next_local_ / EXTENT_SIZE;
+  size_t offset = next_local_ % EXTENT_SIZE;
+  if (extent < extents_.size() && extents_[extent].on_disk_ && offset >= extents_[extent].allocated_) {
+    extents_[extent].allocated_ = std::min(offset + RESERVE_SIZE, EXTENT_SIZE - 1);
+    extents_[extent].dirty_ = true;
+    allocations_unwritten_ = true;
+  }
+  *reused = false;
+  return ToPageId(next_local_++);
+}
+
+void FreePageMap::Free(page_id_t page_id) {
+  if (page_id < 0) {
+    return;
+  }
+  BUSTUB_ASSERT(page_id % num_instances_ == instance_index_, "page belongs to another instance");
+  size_t local = page_id / num_instances_;
+  std::scoped_lock latch(latch_);
+  if (local >= next_local_ || local % EXTENT_SIZE == EXTENT_SIZE - 1) {
+    return;
+  }
+  size_t extent = local / EXTENT_SIZE;
+  if (extent >= extents_.size()) {
+    extents_.resize(extent + 1);
+  }
+  Extent &map = extents_[extent];
+  uint64_t &word = map.bits_[local % EXTENT_SIZE / 64];
+  uint64_t mask = static_cast<uint64_t>(1) << (local % 64);
+  if ((word & mask) != 0) {
+    return;
+  }
+  word |= mask;
+  map.num_free_++;
+  map.dirty_ = true;
+  num_free_++;
+}
+
+void FreePageMap::Flush() {
+  std::scoped_lock flush_latch(flush_latch_);
+  // Copy the dirty map pages under the latch and write them without it, so that allocations do not wait for the disk.
+  std::vector<std::pair<page_id_t, std::vector<char>>> map_pages;
+  {
+    std::scoped_lock latch(latch_);
+    allocations_unwritten_ = false;
+    for (size_t extent = 0; extent < extents_.size(); ++extent) {
+      Extent &map = extents_[extent];
+      if (!map.dirty_) {
+        continue;
+      }
+      if (!map.on_disk_) {
+        // Written for the first time, the map page may end the file; count what is allocated so far, and a bit more.
+        size_t allocated = next_local_ - std::min(next_local_, extent * EXTENT_SIZE);
+        map.allocated_ = std::min(allocated + RESERVE_SIZE, EXTENT_SIZE - 1);
+        map.on_disk_ = true;
+      }
+      MapPageHeader header{MAGIC, instance_index_, static_cast<uint32_t>(extent),
+                           static_cast<uint32_t>(map.allocated_)};
+      std::vector<char> data(PAGE_SIZE);
+      memcpy(data.data(), &header, sizeof(header));
+      memcpy(data.data() + HEADER_SIZE, map.bits_.data(), WORDS_PER_EXTENT * sizeof(uint64_t));
+      map_pages.emplace_back(MapPageId(extent), std::move(data));
+      map.dirty_ = false;
+    }
+  }
+  for (const auto &[page_id, data] : map_pages) {
+    disk_manager_->WritePage(page_id, data.data());
+  }
+}
+
+auto FreePageMap::GetNumFreePages() -> size_t {
+  std::scoped_lock latch(latch_);
+  return num_free_;
+}
+
+auto FreePageMap::FindFree(size_t from) const -> size_t {
+  for (size_t extent = from / EXTENT_SIZE; extent < extents_.size(); ++extent) {
+    if (extents_[extent].num_free_ == 0) {
+      continue;
+    }
+    size_t start = extent == from / EXTENT_SIZE ? from % EXTENT_SIZE : 0;
+    for (size_t word = start / 64; word < WORDS_PER_EXTENT; ++word) {
+      uint64_t bits = extents_[extent].bits_[word];
+      if (word == start / 64) {
+        bits &= ~static_cast<uint64_t>(0) << (start % 64);
+      }
+      if (bits != 0) {
+        return extent * EXTENT_SIZE + word * 64 + __builtin_ctzll(bits);
+      }
+    }
+  }
+  return SIZE_MAX;
+}
+
+}  // namespace bustub
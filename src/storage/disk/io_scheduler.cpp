@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_scheduler.cpp
+//
+// Identification: src/storage/disk/io_scheduler.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/io_scheduler.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace bustub {
+
+namespace {
+
+/** Virtual time a class advances by for a page at weight 1. */
+constexpr uint64_t STRIDE = 1 << 20;
+
+/** Foreground reads and the log go first; read-ahead is worth more than write-back, which only has to keep up. */
+constexpr uint32_t DEFAULT_WEIGHTS[IoScheduler::NUM_IO_CLASSES] = {8, 2, 8, 1};
+
+constexpr const char *CLASS_NAMES[IoScheduler::NUM_IO_CLASSES] = {"demand", "prefetch", "wal", "write-back"};
+
+auto ElapsedUs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) -> uint64_t {
+  return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+}  // namespace
+
+IoScheduler::IoScheduler(size_t max_in_flight) : max_in_flight_(max_in_flight) {
+  BUSTUB_ASSERT(max_in_flight > 0, "the scheduler must admit at least one I/O at a time");
+  for (size_t i = 0; i < NUM_IO_CLASSES; ++i) {
+    queues_[i].weight_ = DEFAULT_WEIGHTS[i];
+  }
+}
+
+void IoScheduler::Run(IoClass io_class, size_t num_pages, const std::function<void()> &io) {
+  ClassQueue &queue = queues_[static_cast<size_t>(io_class)];
+  Waiter waiter;
+  waiter.num_pages_ = num_pages;
+  auto submitted = Clock::now();
+  std::unique_lock<std::mutex> latch(latch_);
+  if (queue.waiters_.empty()) {
+    // An idle class does not get to spend the share it did not use.
+    queue.pass_ = std::max(queue.pass_, global_pass_);
+  }
+  queue.waiters_.push_back(&waiter);
+  queue.stats_.queue_depth_++;
+  queue.stats_.max_queue_depth_ = std::max(queue.stats_.max_queue_depth_, queue.stats_.queue_depth_);
+  Dispatch();
+  while (!waiter.admitted_) {
+    size_t rate = background_io_rate_limit;
+    if (IsBackground(io_class) && rate > 0) {
+      // Nobody may admit us once the bucket refills, so look again when it should have.
+      double missing = std::max(1.0, static_cast<double>(std::min<size_t>(num_pages, BACKGROUND_IO_BURST)) - tokens_);
+      waiter.cv_.wait_for(latch, std::chrono::microseconds(static_cast<int64_t>(missing * 1000000 / rate) + 1));
+    } else {
+      waiter.cv_.wait(latch);
+    }
+    if (!waiter.admitted_) {
+      Dispatch();
+    }
+  }
+  auto admitted = Clock::now();
+  latch.unlock();
+
+  io();
+
+  auto done = Clock::now();
+  latch.lock();
+  in_flight_--;
+  IoClassStats &stats = queue.stats_;
+  stats.in_flight_--;
+  stats.requests_++;
+  stats.pages_ += num_pages;
+  stats.wait_us_ += ElapsedUs(submitted, admitted);
+  stats.max_wait_us_ = std::max(stats.max_wait_us_, ElapsedUs(submitted, admitted));
+  stats.service_us_ += ElapsedUs(admitted, done);
+  Dispatch();
+}
+
+void IoScheduler::SetWeight(IoClass io_class, uint32_t weight) {
+  BUSTUB_ASSERT(weight > 0, "a class needs a weight of at least 1");
+  std::scoped_lock latch(latch_);
+  queues_[static_cast<size_t>(io_class)].weight_ = weight;
+}
+
+auto IoScheduler::GetStats(IoClass io_class) -> IoClassStats {
+  std::scoped_lock latch(latch_);
+  return queues_[static_cast<size_t>(io_class)].stats_;
+}
+
+auto IoScheduler::ToString() -> std::string {
+  std::ostringstream os;
+  for (size_t i = 0; i < NUM_IO_CLASSES; ++i) {
+    IoClassStats stats = GetStats(static_cast<IoClass>(i));
+    os << CLASS_NAMES[i] << ": " << stats.requests_ << " I/Os of " << stats.pages_ << " pages, queue depth "
+       << stats.queue_depth_ << " (max " << stats.max_queue_depth_ << "), in flight " << stats.in_flight_
+       << ", latency avg " << stats.AverageLatency() << " us, wait max " << stats.max_wait_us_ << " us\n";
+  }
+  return os.str();
+}
+
+void IoScheduler::Dispatch() {
+  RefillTokens(Clock::now());
+  bool limited = background_io_rate_limit > 0;
+  while (in_flight_ < max_in_flight_) {
+    ClassQueue *next = nullptr;
+    for (size_t i = 0; i < NUM_IO_CLASSES; ++i) {
+      ClassQueue &queue = queues_[i];
+      if (queue.waiters_.empty() ||
+          (limited && IsBackground(static_cast<IoClass>(i)) && !HasTokens(queue.waiters_.front()->num_pages_))) {
+        continue;
+      }
+      if (next == nullptr || queue.pass_ < next->pass_) {
+        next = &queue;
+      }
+    }
+    if (next == nullptr) {
+      return;
+    }
+
+    Waiter *waiter = next->waiters_.front();
+    next->waiters_.pop_front();
+    if (limited && IsBackground(static_cast<IoClass>(next - queues_))) {
+      tokens_ -= static_cast<double>(waiter->num_pages_);
+    }
+    global_pass_ = next->pass_;
+    next->pass_ += STRIDE * std::max<size_t>(waiter->num_pages_, 1) / next->weight_;
+    next->stats_.queue_depth_--;
+    next->stats_.in_flight_++;
+    in_flight_++;
+    waiter->admitted_ = true;
+    waiter->cv_.notify_one();
+  }
+}
+
+void IoScheduler::RefillTokens(Clock::time_point now) {
+  size_t rate = background_io_rate_limit;
+  if (rate == 0) {
+    tokens_ = BACKGROUND_IO_BURST;
+  } else {
+    double earned = std::chrono::duration<double>(now - last_refill_).count() * static_cast<double>(rate);
+    tokens_ = std::min<double>(BACKGROUND_IO_BURST, tokens_ + earned);
+  }
+  last_refill_ = now;
+}
+
+auto IoScheduler::HasTokens(size_t num_pages) const -> bool {
+  // An I/O larger than the burst waits for a full bucket and leaves it in debt.
+  return tokens_ >= static_cast<double>(std::min<size_t>(num_pages, BACKGROUND_IO_BURST));
+}
+
+}  // namespace bustub
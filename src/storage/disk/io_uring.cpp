@@ -0,0 +1,249 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring.cpp
+//
+// Identification: src/storage/disk/io_uring.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/io_uring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define BUSTUB_HAS_IO_URING
+#endif
+
+namespace bustub {
+
+#ifdef BUSTUB_HAS_IO_URING
+
+namespace {
+
+auto IoUringSetup(unsigned entries, io_uring_params *params) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+auto IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+auto IoUringRegister(int ring_fd, unsigned opcode, const void *arg, unsigned nr_args) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+template <typename T>
+auto RingField(void *ring, uint32_t offset) -> T * {
+  return reinterpret_cast<T *>(static_cast<char *>(ring) + offset);
+}
+
+}  // namespace
+
+auto IoUring::Create(int fd, unsigned queue_depth) -> IoUring * {
+  io_uring_params params{};
+  int ring_fd = IoUringSetup(queue_depth, &params);
+  if (ring_fd < 0) {
+    return nullptr;
+  }
+  auto *ring = new IoUring();
+  ring->fd_ = fd;
+  ring->ring_fd_ = ring_fd;
+  // The kernel rounds the depth up to a power of two; never have more requests in flight than submission entries, so
+  // that the completion queue, twice as large, cannot overflow.
+  ring->queue_depth_ = params.sq_entries;
+
+  ring->sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    ring->sq_ring_size_ = std::max(ring->sq_ring_size_, ring->cq_ring_size_);
+  }
+  ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void *sq_ring = mmap(nullptr, ring->sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                       IORING_OFF_SQ_RING);
+  void *cq_ring = sq_ring;
+  if (!single_mmap && sq_ring != MAP_FAILED) {
+    cq_ring = mmap(nullptr, ring->cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                   IORING_OFF_CQ_RING);
+  }
+  void *sqes = MAP_FAILED;
+  if (sq_ring != MAP_FAILED && cq_ring != MAP_FAILED) {
+    sqes = mmap(nullptr, ring->sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                IORING_OFF_SQES);
+  }
+  ring->sq_ring_ = sq_ring == MAP_FAILED ? nullptr : sq_ring;
+  ring->cq_ring_ = cq_ring == MAP_FAILED || single_mmap ? nullptr : cq_ring;
+  ring->sqes_ = sqes == MAP_FAILED ? nullptr : sqes;
+  if (sqes == MAP_FAILED) {
+    delete ring;
+    return nullptr;
+  }
+
+  ring->sq_tail_ = RingField<unsigned>(sq_ring, params.sq_off.tail);
+  ring->sq_mask_ = RingField<unsigned>(sq_ring, params.sq_off.ring_mask);
+  ring->sq_array_ = RingField<unsigned>(sq_ring, params.sq_off.array);
+  ring->cq_head_ = RingField<unsigned>(cq_ring, params.cq_off.head);
+  ring->cq_tail_ = RingField<unsigned>(cq_ring, params.cq_off.tail);
+  ring->cq_mask_ = RingField<unsigned>(cq_ring, params.cq_off.ring_mask);
+  ring->cqes_ = RingField<io_uring_cqe>(cq_ring, params.cq_off.cqes);
+  ring->completion_thread_ = new std::thread(&IoUring::RunCompletions, ring);
+  return ring;
+}
+
+IoUring::~IoUring() {
+  if (completion_thread_ != nullptr) {
+    std::unique_lock<std::mutex> latch(latch_);
+    completed_cv_.wait(latch, [&] { return in_flight_ == 0; });
+    // A no-op without user data tells the completion thread to stop.
+    unsigned tail = *sq_tail_;
+    unsigned index = tail & *sq_mask_;
+    auto *sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_NOP;
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    while (IoUringEnter(ring_fd_, 1, 0, 0) < 0 && errno == EINTR) {
+    }
+    latch.unlock();
+    completion_thread_->join();
+    delete completion_thread_;
+  }
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  close(ring_fd_);
+}
+
+void IoUring::Submit(Request *requests, size_t num_requests) {
+  std::unique_lock<std::mutex> latch(latch_);
+  size_t next = 0;
+  while (next < num_requests) {
+    completed_cv_.wait(latch, [&] { return in_flight_ < queue_depth_; });
+    // Queue as much of the batch as the ring takes, then submit it with one system call.
+    unsigned tail = *sq_tail_;
+    unsigned queued = 0;
+    while (next < num_requests && in_flight_ + queued < queue_depth_) {
+      Request &request = requests[next++];
+      unsigned index = (tail + queued) & *sq_mask_;
+      auto *sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+      memset(sqe, 0, sizeof(*sqe));
+      auto *in_flight = new InFlight{{request.data_, request.size_}, std::move(request.callback_)};
+      int buffer_index = FindFixedBuffer(request.data_, request.size_);
+      if (buffer_index >= 0) {
+        sqe->opcode = request.is_write_ ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+        sqe->addr = reinterpret_cast<uint64_t>(request.data_);
+        sqe->len = request.size_;
+        sqe->buf_index = buffer_index;
+      } else {
+        sqe->opcode = request.is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+        sqe->addr = reinterpret_cast<uint64_t>(&in_flight->iov_);
+        sqe->len = 1;
+      }
+      sqe->fd = fd_;
+      sqe->off = request.offset_;
+      sqe->user_data = reinterpret_cast<uint64_t>(in_flight);
+      sq_array_[index] = index;
+      queued++;
+    }
+    __atomic_store_n(sq_tail_, tail + queued, __ATOMIC_RELEASE);
+    in_flight_ += queued;
+    // Without a polling thread the kernel consumes every queued entry before the call returns, unless it fails.
+    unsigned submitted = 0;
+    while (submitted < queued) {
+      int rc = IoUringEnter(ring_fd_, queued - submitted, 0, 0);
+      if (rc < 0) {
+        BUSTUB_ASSERT(errno == EINTR || errno == EAGAIN || errno == EBUSY, "io_uring_enter failed");
+        continue;
+      }
+      submitted += rc;
+    }
+  }
+}
+
+auto IoUring::RegisterBuffers(const std::vector<iovec> &buffers) -> bool {
+  std::unique_lock<std::mutex> latch(latch_);
+  completed_cv_.wait(latch, [&] { return in_flight_ == 0; });
+  if (!fixed_buffers_.empty()) {
+    IoUringRegister(ring_fd_, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+    fixed_buffers_.clear();
+  }
+  if (buffers.empty()) {
+    return true;
+  }
+  if (IoUringRegister(ring_fd_, IORING_REGISTER_BUFFERS, buffers.data(), buffers.size()) != 0) {
+    return false;
+  }
+  fixed_buffers_ = buffers;
+  return true;
+}
+
+void IoUring::RunCompletions() {
+  bool shutdown = false;
+  while (!shutdown) {
+    if (IoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+      BUSTUB_ASSERT(errno == EAGAIN || errno == EBUSY, "io_uring_enter failed");
+    }
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    size_t completed = 0;
+    for (; head != tail; ++head) {
+      auto *cqe = static_cast<io_uring_cqe *>(cqes_) + (head & *cq_mask_);
+      auto *in_flight = reinterpret_cast<InFlight *>(cqe->user_data);
+      ssize_t result = cqe->res;
+      // Hand the entry back to the kernel before running the callback, which may take a while.
+      __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+      if (in_flight == nullptr) {
+        shutdown = true;
+        continue;
+      }
+      in_flight->callback_(result);
+      delete in_flight;
+      completed++;
+    }
+    if (completed != 0) {
+      std::scoped_lock latch(latch_);
+      in_flight_ -= completed;
+      completed_cv_.notify_all();
+    }
+  }
+}
+
+auto IoUring::FindFixedBuffer(const char *data, size_t size) const -> int {
+  for (size_t i = 0; i < fixed_buffers_.size(); ++i) {
+    const char *base = static_cast<const char *>(fixed_buffers_[i].iov_base);
+    if (data >= base && data + size <= base + fixed_buffers_[i].iov_len) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+#else
+
+auto IoUring::Create(int fd, unsigned queue_depth) -> IoUring * { return nullptr; }
+
+IoUring::~IoUring() = default;
+
+void IoUring::Submit(Request *requests, size_t num_requests) { UNREACHABLE("io_uring is not available"); }
+
+auto IoUring::RegisterBuffers(const std::vector<iovec> &buffers) -> bool { return false; }
+
+#endif
+
+}  // namespace bustub
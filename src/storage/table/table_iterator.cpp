@@ -16,8 +16,8 @@
 
 namespace bustub {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy)
+    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn), strategy_(strategy) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
     table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
   }
@@ -35,19 +35,25 @@ auto TableIterator::operator->() -> Tuple * {
 
 auto TableIterator::operator++() -> TableIterator & {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
+  auto cur_page =
+      static_cast<TablePage *>(buffer_pool_manager->FetchPageWithStrategy(tuple_->rid_.GetPageId(), strategy_));
   cur_page->RLatch();
   assert(cur_page != nullptr);  // all pages are pinned
+  if (read_ahead_page_ == INVALID_PAGE_ID) {
+    ReadAhead(cur_page, false);
+  }
 
   RID next_tuple_rid;
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
+      auto next_page =
+          static_cast<TablePage *>(buffer_pool_manager->FetchPageWithStrategy(cur_page->GetNextPageId(), strategy_));
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
       cur_page = next_page;
       cur_page->RLatch();
+      ReadAhead(cur_page, true);
       if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
         break;
       }
@@ -64,6 +70,41 @@ auto TableIterator::operator++() -> TableIterator & {
   return *this;
 }
 
+void TableIterator::ReadAhead(TablePage *page, bool advanced) {
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  if (advanced && read_ahead_depth_ > 0) {
+    read_ahead_depth_--;
+  } else {
+    read_ahead_page_ = page->GetTablePageId();
+    read_ahead_depth_ = 0;
+  }
+
+  // The id of a heap page is only known once the page before it is in memory, so the window can only be extended
+  // past pages whose read has completed. Pages still being read stop the walk until the cursor moves on.
+  size_t window = scan_prefetch_window;
+  while (read_ahead_depth_ < window) {
+    page_id_t next_page_id;
+    if (read_ahead_page_ == page->GetTablePageId()) {
+      next_page_id = page->GetNextPageId();
+    } else {
+      auto frontier = static_cast<TablePage *>(buffer_pool_manager->FetchResidentPage(read_ahead_page_));
+      if (frontier == nullptr) {
+        break;
+      }
+      frontier->RLatch();
+      next_page_id = frontier->GetNextPageId();
+      frontier->RUnlatch();
+      buffer_pool_manager->UnpinPage(read_ahead_page_, false);
+    }
+    if (next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    buffer_pool_manager->PrefetchPage(next_page_id);
+    read_ahead_page_ = next_page_id;
+    read_ahead_depth_++;
+  }
+}
+
 auto TableIterator::operator++(int) -> TableIterator {
   TableIterator clone(*this);
   ++(*this);
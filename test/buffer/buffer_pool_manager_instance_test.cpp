@@ -11,14 +11,36 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <cstring>
+#include <functional>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_warmer.h"
+#include "buffer/optimistic_page_guard.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
+/** Poll a condition set by a background thread until it holds, or give up after a generous deadline. */
+static auto WaitUntil(const std::function<bool()> &condition) -> bool {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
 // NOLINTNEXTLINE
 // Check whether pages containing terminal characters can be recovered
 TEST(BufferPoolManagerInstanceTest, BinaryDataTest) {
@@ -141,4 +163,1088 @@ TEST(BufferPoolManagerInstanceTest, SampleTest) {
   delete disk_manager;
 }
 
+// Check that concurrent misses, hits and evictions never observe a page that is still being read in
+void ConcurrentFetchTest(ReplacerPolicy replacer_policy) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 32;
+  const int num_threads = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, replacer_policy);
+
+  // Scenario: Write a distinct tag into every page, which pushes most of them out to disk.
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: Several threads fetch overlapping pages; every fetch must see the fully read page content.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid] {
+      char expected[PAGE_SIZE];
+      for (int round = 0; round < 200; ++round) {
+        page_id_t page_id = (round * 7 + tid) % num_pages;
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        snprintf(expected, PAGE_SIZE, "page-%d", page_id);
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentFetchTest) {
+  ConcurrentFetchTest(ReplacerPolicy::LRU);
+  ConcurrentFetchTest(ReplacerPolicy::CLOCK);
+  ConcurrentFetchTest(ReplacerPolicy::LRU_K);
+}
+
+// NOLINTNEXTLINE
+// Check that dirty pages reach the disk through the page cleaner without an explicit flush
+TEST(BufferPoolManagerInstanceTest, PageCleanerTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page0);
+  snprintf(page0->GetData(), PAGE_SIZE, "Hello");
+
+  // Scenario: Unpinning a dirty page does not write it, the cleaner does so in the background.
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  EXPECT_EQ(true, WaitUntil([&] { return bpm->GetStats().write_backs_ == 1; }));
+
+  char buffer[PAGE_SIZE];
+  disk_manager->ReadPage(page_id_temp, buffer);
+  EXPECT_EQ(0, strcmp(buffer, "Hello"));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Check that dirty pages the page cleaner did not get to yet are written, whichever of the pool and its disk manager
+// is torn down first
+TEST(BufferPoolManagerInstanceTest, DestructorFlushTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  auto saved_interval = page_cleaner_interval;
+  page_cleaner_interval = std::chrono::hours(1);
+  char buffer[PAGE_SIZE];
+  page_id_t page_ids[3];
+  auto dirty_page = [](BufferPoolManager *bpm, const char *content, page_id_t *page_id) {
+    auto *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%s", content);
+    EXPECT_EQ(true, bpm->UnpinPage(*page_id, true));
+  };
+
+  // Scenario: The cleaner is not due for an hour, so only the destructor writes the page.
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  dirty_page(bpm, "Hello", &page_ids[0]);
+  delete bpm;
+  disk_manager->ReadPage(page_ids[0], buffer);
+  EXPECT_EQ(0, strcmp(buffer, "Hello"));
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  // Scenario: Shutting down the disk manager first writes the page before the file is closed.
+  disk_manager = new DiskManager(db_name);
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  dirty_page(bpm, "World", &page_ids[1]);
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+
+  // Scenario: Deleting the disk manager first writes the page too, and leaves nothing for the pool to touch.
+  disk_manager = new DiskManager(db_name);
+  disk_manager->ReadPage(page_ids[1], buffer);
+  EXPECT_EQ(0, strcmp(buffer, "World"));
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  dirty_page(bpm, "Again", &page_ids[2]);
+  delete disk_manager;
+  delete bpm;
+
+  disk_manager = new DiskManager(db_name);
+  disk_manager->ReadPage(page_ids[2], buffer);
+  EXPECT_EQ(0, strcmp(buffer, "Again"));
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  page_cleaner_interval = saved_interval;
+}
+
+/** A memory-backed disk whose writes fail on demand. */
+class FailingDiskManager : public DiskManagerMemory {
+ public:
+  std::atomic<bool> fail_writes_{false};
+  std::atomic<int> failed_writes_{0};
+
+ protected:
+  auto TransferPagesAt(bool is_write, page_id_t first_page_id, char *const *pages_data, size_t num_pages)
+      -> bool override {
+    if (is_write && fail_writes_) {
+      failed_writes_++;
+      return false;
+    }
+    return DiskManagerMemory::TransferPagesAt(is_write, first_page_id, pages_data, num_pages);
+  }
+};
+
+// NOLINTNEXTLINE
+// Check that a page whose write-back failed stays dirty instead of losing its change
+TEST(BufferPoolManagerInstanceTest, WriteBackFailureTest) {
+  const size_t buffer_pool_size = 10;
+  auto *disk_manager = new FailingDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // The first two pages go out as a run, the last one, after a clean page, on its own.
+  page_id_t page_ids[4];
+  for (auto &page_id : page_ids) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+  }
+  const std::vector<page_id_t> dirty_page_ids = {page_ids[0], page_ids[1], page_ids[3]};
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[2], false));
+  char buffer[PAGE_SIZE];
+  char expected[PAGE_SIZE];
+
+  // Scenario: Neither the page cleaner nor a flush loses the changes when the disk fails.
+  disk_manager->fail_writes_ = true;
+  for (auto page_id : dirty_page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_EQ(true, WaitUntil([&] { return disk_manager->failed_writes_ > 0; }));
+  bpm->FlushAllPages();
+  for (auto page_id : dirty_page_ids) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(true, page->IsDirty());
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: Once the disk recovers, the pages are written after all.
+  disk_manager->fail_writes_ = false;
+  bpm->FlushAllPages();
+  for (auto page_id : dirty_page_ids) {
+    disk_manager->ReadPage(page_id, buffer);
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_STREQ(expected, buffer);
+  }
+
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Check that fetches do not wait for write-backs and read-ahead held back by the background I/O rate limit
+TEST(BufferPoolManagerInstanceTest, BackgroundIoPriorityTest) {
+  using std::chrono::milliseconds;
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  char data[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < 2; ++page_id) {
+    snprintf(data, sizeof(data), "page %d", page_id);
+    disk_manager->WritePage(page_id, data);
+  }
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  Page *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+
+  // Spend the saved up budget of background I/O, which then refills at a page per second.
+  background_io_rate_limit = 1;
+  disk_manager->GetIoScheduler()->Run(IoClass::WRITE_BACK, BACKGROUND_IO_BURST, [] {});
+
+  // Scenario: The page cleaner waits for its budget to write a dirty page, but a fetch of the page does not.
+  snprintf(page->GetData(), PAGE_SIZE, "Hello");
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  auto *scheduler = disk_manager->GetIoScheduler();
+  EXPECT_EQ(true, WaitUntil([&] { return scheduler->GetStats(IoClass::WRITE_BACK).queue_depth_ == 1; }));
+  auto start = std::chrono::steady_clock::now();
+  page = bpm->FetchPage(0);
+  EXPECT_GT(milliseconds(500), std::chrono::steady_clock::now() - start);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "Hello"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  // Scenario: A page waiting to be read ahead is read by a fetch of it right away.
+  bpm->PrefetchPage(1);
+  EXPECT_EQ(true, WaitUntil([&] { return scheduler->GetStats(IoClass::PREFETCH).queue_depth_ == 1; }));
+  start = std::chrono::steady_clock::now();
+  page = bpm->FetchPage(1);
+  EXPECT_GT(milliseconds(500), std::chrono::steady_clock::now() - start);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "page 1"));
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+
+  background_io_rate_limit = 0;
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Check that a scan with a bulk read strategy recycles its ring instead of flushing the rest of the pool
+TEST(BufferPoolManagerInstanceTest, BufferAccessStrategyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_hot_pages = 5;
+  const int num_scan_pages = 50;
+  // Keep the page cleaner from moving hot pages to the free list behind our back.
+  const size_t free_frames = page_cleaner_free_frames.exchange(0);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_hot_pages + num_scan_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  // Scenario: Touch the hot pages so that they are resident, with the fetch the grading callbacks use.
+  for (page_id_t page_id = 0; page_id < num_hot_pages; ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id, nullptr));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: Scan every other page through a ring of two frames.
+  BufferAccessStrategy strategy(2);
+  for (page_id_t page_id = num_hot_pages; page_id < num_hot_pages + num_scan_pages; ++page_id) {
+    auto *page = bpm->FetchPageWithStrategy(page_id, &strategy);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id, page->GetPageId());
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: The hot pages are still in the buffer pool.
+  int resident = 0;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id = bpm->GetPages()[i].GetPageId();
+    resident += page_id != INVALID_PAGE_ID && page_id < num_hot_pages ? 1 : 0;
+  }
+  EXPECT_EQ(num_hot_pages, resident);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+  page_cleaner_free_frames = free_frames;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PagePriorityTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const int num_scan_pages = 40;
+  // Keep the page cleaner from moving pages to the free list behind our back.
+  const size_t free_frames = page_cleaner_free_frames.exchange(0);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: Create two high priority pages, like the roots of two indexes.
+  page_id_t high_page_ids[2];
+  for (auto &page_id : high_page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPageWithPriority(&page_id, PagePriority::HIGH));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: A scan much larger than the pool, fetching the high priority pages now and then without a hint.
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_scan_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+    if (i % 10 == 0) {
+      ASSERT_NE(nullptr, bpm->FetchPage(high_page_ids[0]));
+      EXPECT_EQ(true, bpm->UnpinPage(high_page_ids[0], false));
+    }
+  }
+
+  // Scenario: The high priority pages are still in the buffer pool.
+  for (auto page_id : high_page_ids) {
+    Page *page = bpm->FetchResidentPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: Once every normal frame is pinned, the high priority pages are evicted after all.
+  std::vector<page_id_t> pinned;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    pinned.push_back(page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->FetchResidentPage(high_page_ids[0]));
+  EXPECT_EQ(nullptr, bpm->FetchResidentPage(high_page_ids[1]));
+  for (auto page_id : pinned) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+  page_cleaner_free_frames = free_frames;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DeletePageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: A page written to disk and deleted is handed out again, empty.
+  page_id_t deleted_page_id;
+  Page *page = bpm->NewPage(&deleted_page_id);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), PAGE_SIZE, "Hello");
+  EXPECT_EQ(true, bpm->UnpinPage(deleted_page_id, true));
+  bpm->FlushAllPages();
+  EXPECT_EQ(true, bpm->DeletePage(deleted_page_id));
+  page_id_t page_id_temp;
+  page = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(deleted_page_id, page_id_temp);
+  EXPECT_EQ(0, page->GetData()[0]);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+
+  // Scenario: Once evicted, the reused page still reads back empty rather than with its old content.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_NE(deleted_page_id, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  page = bpm->FetchPage(deleted_page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, page->GetData()[0]);
+  EXPECT_EQ(true, bpm->UnpinPage(deleted_page_id, false));
+
+  // Scenario: Pages deleted before a restart are reused after it, and the others are not handed out again.
+  EXPECT_EQ(true, bpm->DeletePage(page_id_temp));
+  bpm->FlushAllPages();
+  delete bpm;
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  EXPECT_EQ(1, bpm->GetNumFreePages());
+  page_id_t reused_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&reused_page_id));
+  EXPECT_EQ(page_id_temp, reused_page_id);
+  EXPECT_EQ(true, bpm->UnpinPage(reused_page_id, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_LT(reused_page_id, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_pages = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  char data[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    snprintf(data, sizeof(data), "page %d", page_id);
+    disk_manager->WritePage(page_id, data);
+  }
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: Pages that are not resident cannot be fetched without I/O.
+  EXPECT_EQ(nullptr, bpm->FetchResidentPage(0));
+
+  // Scenario: Read the pages ahead and wait until they are all resident.
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    bpm->PrefetchPage(page_id);
+  }
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    Page *page;
+    while ((page = bpm->FetchResidentPage(page_id)) == nullptr) {
+      std::this_thread::yield();
+    }
+    snprintf(data, sizeof(data), "page %d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), data));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: Pages read ahead are left unpinned, so every frame can still be used for new pages.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FetchPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  char data[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < 20; ++page_id) {
+    snprintf(data, sizeof(data), "page %d", page_id);
+    disk_manager->WritePage(page_id, data);
+  }
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: Fetch a batch mixing a resident page, missing pages and a duplicate.
+  Page *page3 = bpm->FetchPage(3);
+  ASSERT_NE(nullptr, page3);
+  const page_id_t page_ids[] = {7, 3, 1, 7, 5};
+  Page *pages[5];
+  EXPECT_EQ(true, bpm->FetchPages(page_ids, 5, pages));
+  for (size_t i = 0; i < 5; ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+    snprintf(data, sizeof(data), "page %d", page_ids[i]);
+    EXPECT_EQ(0, strcmp(pages[i]->GetData(), data));
+  }
+  EXPECT_EQ(page3, pages[1]);
+  EXPECT_EQ(2, page3->GetPinCount());
+  EXPECT_EQ(2, pages[0]->GetPinCount());
+
+  // Scenario: Unpin the batch at once.
+  EXPECT_EQ(true, bpm->UnpinPages(page_ids, 5, false));
+  EXPECT_EQ(1, page3->GetPinCount());
+  EXPECT_EQ(0, pages[0]->GetPinCount());
+  EXPECT_EQ(true, bpm->UnpinPage(3, false));
+
+  // Scenario: A batch larger than the buffer pool can only be fetched in part.
+  page_id_t many_page_ids[buffer_pool_size + 2];
+  Page *many_pages[buffer_pool_size + 2];
+  for (size_t i = 0; i < buffer_pool_size + 2; ++i) {
+    many_page_ids[i] = static_cast<page_id_t>(i);
+  }
+  EXPECT_EQ(false, bpm->FetchPages(many_page_ids, buffer_pool_size + 2, many_pages));
+  for (size_t i = 0; i < buffer_pool_size + 2; ++i) {
+    EXPECT_EQ(i < buffer_pool_size, many_pages[i] != nullptr);
+  }
+  EXPECT_EQ(true, bpm->UnpinPages(many_page_ids, buffer_pool_size, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, OptimisticPageGuardTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 3;
+  const int num_readers = 4;
+  const int num_writes = 10000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+
+  // Scenario: An unpinned resident page is read without taking a pin.
+  {
+    OptimisticPageGuard guard(bpm, page_id);
+    EXPECT_EQ(true, guard.IsOptimistic());
+    EXPECT_EQ(page->GetData(), guard.GetData());
+    EXPECT_EQ(0, page->GetPinCount());
+    EXPECT_EQ(true, guard.Validate());
+  }
+
+  // Scenario: Readers never validate a torn read of two counters that a writer keeps equal.
+  std::vector<std::thread> readers;
+  std::atomic<bool> done = false;
+  for (int tid = 0; tid < num_readers; ++tid) {
+    readers.emplace_back([&] {
+      while (!done) {
+        int first;
+        int second;
+        OptimisticPageGuard guard(bpm, page_id);
+        do {
+          memcpy(&first, guard.GetData(), sizeof(int));
+          memcpy(&second, guard.GetData() + PAGE_SIZE - sizeof(int), sizeof(int));
+        } while (!guard.Validate());
+        EXPECT_EQ(first, second);
+      }
+    });
+  }
+  ASSERT_EQ(page, bpm->FetchPage(page_id));
+  for (int i = 1; i <= num_writes; ++i) {
+    page->WLatch();
+    memcpy(page->GetData(), &i, sizeof(int));
+    memcpy(page->GetData() + PAGE_SIZE - sizeof(int), &i, sizeof(int));
+    page->WUnlatch();
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+
+  // Scenario: A page that is only read optimistically is passed over once when it is picked for eviction. The page
+  // is flushed first so that the page cleaner, woken up by the evictions, does not write it during the reads.
+  EXPECT_EQ(true, bpm->FlushPage(page_id));
+  {
+    OptimisticPageGuard guard(bpm, page_id);
+    EXPECT_EQ(true, guard.IsOptimistic());
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+    }
+    EXPECT_EQ(true, guard.Validate());
+    EXPECT_EQ(true, guard.IsOptimistic());
+  }
+
+  // Scenario: Reusing the frame for another page invalidates the read, and the next attempt reads from disk.
+  {
+    OptimisticPageGuard guard(bpm, page_id);
+    EXPECT_EQ(true, guard.IsOptimistic());
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+    }
+    EXPECT_EQ(false, guard.Validate());
+    EXPECT_EQ(false, guard.IsOptimistic());
+    int value;
+    memcpy(&value, guard.GetData(), sizeof(int));
+    EXPECT_EQ(num_writes, value);
+    EXPECT_EQ(true, guard.Validate());
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FrameLayoutTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: The book-keeping of every frame starts on a cache line of its own, and the page data lives in one
+  // huge page aligned arena, frame after frame.
+  Page *pages = bpm->GetPages();
+  auto first_frame = reinterpret_cast<uintptr_t>(pages[0].GetData());
+  EXPECT_EQ(0, first_frame % HUGE_PAGE_SIZE);
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(&pages[i]) % CACHE_LINE_SIZE);
+    EXPECT_EQ(first_frame + i * PAGE_SIZE, reinterpret_cast<uintptr_t>(pages[i].GetData()));
+  }
+
+  // Scenario: Pages of the pool and standalone pages start out zeroed.
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  char zeros[PAGE_SIZE] = {0};
+  EXPECT_EQ(0, memcmp(page->GetData(), zeros, PAGE_SIZE));
+  Page standalone;
+  EXPECT_EQ(0, memcmp(standalone.GetData(), zeros, PAGE_SIZE));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t max_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm =
+      new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerPolicy::LRU, max_pool_size);
+
+  // Scenario: The pool cannot grow beyond the frames reserved for it, nor shrink to nothing.
+  EXPECT_EQ(false, bpm->Resize(max_pool_size + 1));
+  EXPECT_EQ(false, bpm->Resize(0));
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+
+  // Scenario: Growing the pool adds frames for new pages.
+  std::vector<page_id_t> page_ids(max_pool_size);
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_ids[i]));
+  }
+  page_id_t page_id_temp;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(true, bpm->Resize(max_pool_size));
+  EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+  for (size_t i = buffer_pool_size; i < max_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_ids[i]));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  for (auto page_id : page_ids) {
+    Page *page = bpm->FetchPage(page_id);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: Shrinking waits for the pages in the frames given up to be unpinned, and writes them back.
+  const size_t shrunk_pool_size = 3;
+  page_id_t pinned_page_id = bpm->GetPages()[max_pool_size - 1].GetPageId();
+  ASSERT_NE(nullptr, bpm->FetchPage(pinned_page_id));
+  std::atomic<bool> unpinned{false};
+  std::thread unpinner([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    unpinned = true;
+    bpm->UnpinPage(pinned_page_id, false);
+  });
+  EXPECT_EQ(true, bpm->Resize(shrunk_pool_size));
+  EXPECT_EQ(true, unpinned);
+  unpinner.join();
+  EXPECT_EQ(shrunk_pool_size, bpm->GetPoolSize());
+  for (size_t i = shrunk_pool_size; i < max_pool_size; ++i) {
+    EXPECT_EQ(INVALID_PAGE_ID, bpm->GetPages()[i].GetPageId());
+  }
+  char data[PAGE_SIZE];
+  for (auto page_id : page_ids) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(data, sizeof(data), "page %d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), data));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: Fetches keep working while the pool grows and shrinks under them.
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; ++tid) {
+    threads.emplace_back([&, tid] {
+      std::mt19937 rng(tid);
+      char expected[PAGE_SIZE];
+      while (!done) {
+        page_id_t page_id = page_ids[rng() % page_ids.size()];
+        Page *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        snprintf(expected, sizeof(expected), "page %d", page_id);
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (int round = 0; round < 20; ++round) {
+    EXPECT_EQ(true, bpm->Resize(round % 2 == 0 ? max_pool_size : shrunk_pool_size));
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(shrunk_pool_size, bpm->GetPoolSize());
+
+  // Scenario: A page that stays pinned makes shrinking give up, with the pool back at its old size and every frame
+  // in use again.
+  auto saved_resize_timeout = resize_timeout;
+  resize_timeout = std::chrono::milliseconds(50);
+  EXPECT_EQ(true, bpm->Resize(max_pool_size));
+  for (auto page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+  }
+  pinned_page_id = bpm->GetPages()[max_pool_size - 1].GetPageId();
+  for (auto page_id : page_ids) {
+    if (page_id != pinned_page_id) {
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+  }
+  EXPECT_EQ(false, bpm->Resize(shrunk_pool_size));
+  EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+  for (auto page_id : page_ids) {
+    if (page_id != pinned_page_id) {
+      Page *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(data, sizeof(data), "page %d", page_id);
+      EXPECT_EQ(0, strcmp(page->GetData(), data));
+    }
+  }
+  for (auto page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  resize_timeout = saved_resize_timeout;
+  EXPECT_EQ(true, bpm->Resize(shrunk_pool_size));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Check that shrinking the pool waits for a read-ahead holding a frame beyond the new size
+TEST(BufferPoolManagerInstanceTest, ResizePrefetchTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t shrunk_pool_size = 4;
+  const page_id_t prefetched_page_id = 100;
+  // Keep the page cleaner from refilling the free list behind our back.
+  const size_t free_frames = page_cleaner_free_frames.exchange(0);
+
+  auto *disk_manager = new DiskManagerMemory();
+  char data[PAGE_SIZE] = {0};
+  snprintf(data, sizeof(data), "page %d", prefetched_page_id);
+  disk_manager->WritePage(prefetched_page_id, data);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size - 2; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Spend the saved up budget of background I/O, which then refills at a page per second.
+  background_io_rate_limit = 1;
+  disk_manager->GetIoScheduler()->Run(IoClass::WRITE_BACK, BACKGROUND_IO_BURST, [] {});
+
+  // Scenario: The read-ahead worker takes one of the two free frames, both beyond the new size, and waits for its
+  // budget.
+  bpm->PrefetchPage(prefetched_page_id);
+  EXPECT_EQ(true, WaitUntil([&] { return bpm->GetStats().free_frames_ == 1; }));
+
+  // Scenario: Shrinking waits for the read-ahead, and then evicts the page it read into a frame given up.
+  EXPECT_EQ(true, bpm->Resize(shrunk_pool_size));
+  EXPECT_EQ(1, disk_manager->GetIoScheduler()->GetStats(IoClass::PREFETCH).requests_);
+  for (size_t i = shrunk_pool_size; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(INVALID_PAGE_ID, bpm->GetPages()[i].GetPageId());
+  }
+
+  // Scenario: Once the pool grows again, new pages in the frames given back leave the page read ahead alone.
+  EXPECT_EQ(true, bpm->Resize(buffer_pool_size));
+  for (size_t i = shrunk_pool_size; i < buffer_pool_size; ++i) {
+    Page *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  Page *page = bpm->FetchPage(prefetched_page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), data));
+  EXPECT_EQ(true, bpm->UnpinPage(prefetched_page_id, false));
+
+  background_io_rate_limit = 0;
+  page_cleaner_free_frames = free_frames;
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, WarmupTest) {
+  const std::string db_name = "test.db";
+  const std::string warm_name = "test.warm";
+  const size_t buffer_pool_size = 10;
+  // Keep the page cleaner from moving loaded pages to the free list behind our back.
+  const size_t free_frames = page_cleaner_free_frames.exchange(0);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  std::vector<page_id_t> page_ids(buffer_pool_size);
+  for (auto &page_id : page_ids) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: The resident pages are listed most recently used first.
+  for (auto page_id : {page_ids[3], page_ids[7]}) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  std::vector<page_id_t> resident = bpm->GetResidentPages();
+  ASSERT_EQ(buffer_pool_size, resident.size());
+  EXPECT_EQ(page_ids[7], resident[0]);
+  EXPECT_EQ(page_ids[3], resident[1]);
+  EXPECT_EQ(true, BufferPoolWarmer(bpm, warm_name).Save());
+  delete bpm;
+
+  // Scenario: A new buffer pool loads the saved pages back with their data.
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  EXPECT_EQ(buffer_pool_size, BufferPoolWarmer(bpm, warm_name).Load());
+  std::vector<page_id_t> loaded = bpm->GetResidentPages();
+  EXPECT_EQ(buffer_pool_size, loaded.size());
+  EXPECT_EQ(page_ids[7], loaded[0]);
+  EXPECT_EQ(page_ids[3], loaded[1]);
+  char data[PAGE_SIZE];
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    Page *page = bpm->GetPages() + i;
+    snprintf(data, sizeof(data), "page %d", page->GetPageId());
+    EXPECT_EQ(0, strcmp(page->GetData(), data));
+    EXPECT_EQ(0, page->GetPinCount());
+  }
+  delete bpm;
+
+  // Scenario: A smaller buffer pool loads only the most recently used pages.
+  bpm = new BufferPoolManagerInstance(2, disk_manager);
+  EXPECT_EQ(2, BufferPoolWarmer(bpm, warm_name).Load());
+  std::vector<page_id_t> hot = bpm->GetResidentPages();
+  std::sort(hot.begin(), hot.end());
+  EXPECT_EQ(std::vector<page_id_t>({page_ids[3], page_ids[7]}), hot);
+  delete bpm;
+
+  // Scenario: A missing or foreign side file loads nothing.
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  remove(warm_name.c_str());
+  EXPECT_EQ(0, BufferPoolWarmer(bpm, warm_name).Load());
+  EXPECT_EQ(0, BufferPoolWarmer(bpm, db_name).Load());
+  EXPECT_EQ(true, bpm->GetResidentPages().empty());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove(warm_name.c_str());
+
+  delete bpm;
+  delete disk_manager;  page_cleaner_free_frames = free_frames;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, StatsTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: Pinning every frame raises the high-water mark and drains the free list.
+  std::vector<page_id_t> page_ids(buffer_pool_size + 1);
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_ids[i]));
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+  }
+  BufferPoolStats stats = bpm->GetStats();
+  EXPECT_EQ(buffer_pool_size, stats.pinned_high_water_);
+  EXPECT_EQ(0, stats.free_frames_);
+  EXPECT_EQ(0, stats.hits_);
+  EXPECT_EQ(0, stats.misses_);
+
+  // Scenario: Fetching a resident page is a hit; evicting clean pages to make room for new ones needs no write-back.
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids[0]));
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[0], false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_ids[buffer_pool_size]));
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[buffer_pool_size], false));
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids[1]));
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[1], true));
+  stats = bpm->GetStats();
+  EXPECT_EQ(1, stats.hits_);
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_EQ(2, stats.clean_evictions_);
+  EXPECT_EQ(0, stats.dirty_evictions_);
+  EXPECT_EQ(buffer_pool_size, stats.pinned_high_water_);
+  uint64_t timed_misses = 0;
+  for (auto count : stats.miss_latency_) {
+    timed_misses += count;
+  }
+  EXPECT_EQ(1, timed_misses);
+
+  // Scenario: A dirty page is written back, by the flush or by the page cleaner before it.
+  bpm->FlushPage(page_ids[1]);
+  stats = bpm->GetStats();
+  EXPECT_LE(1, stats.write_backs_);
+  EXPECT_NE(std::string::npos, stats.ToString().find("hits: 1, misses: 1"));
+
+  // Scenario: The latency histogram has power of two buckets.
+  BufferPoolStats histogram;
+  EXPECT_EQ(0, BufferPoolStats::LatencyBucket(0));
+  EXPECT_EQ(1, BufferPoolStats::LatencyBucket(1));
+  EXPECT_EQ(2, BufferPoolStats::LatencyBucket(3));
+  EXPECT_EQ(3, BufferPoolStats::LatencyBucket(4));
+  EXPECT_EQ(0, histogram.MissLatencyPercentile(50));
+  histogram.miss_latency_[BufferPoolStats::LatencyBucket(100)] = 99;
+  histogram.miss_latency_[BufferPoolStats::LatencyBucket(5000)] = 1;
+  EXPECT_EQ(128, histogram.MissLatencyPercentile(50));
+  EXPECT_EQ(128, histogram.MissLatencyPercentile(99));
+  EXPECT_EQ(8192, histogram.MissLatencyPercentile(100));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, CompressedPageCacheTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+  const size_t num_pages = 6;
+
+  compressed_page_cache_size = 16 * PAGE_SIZE;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  compressed_page_cache_size = 0;
+
+  std::vector<page_id_t> page_ids(num_pages);
+  for (auto &page_id : page_ids) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: Evicted pages are read back from the compressed page cache instead of the disk.
+  char data[PAGE_SIZE];
+  for (int round = 0; round < 2; ++round) {
+    for (auto page_id : page_ids) {
+      Page *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(data, sizeof(data), "page %d", page_id);
+      EXPECT_EQ(0, strcmp(page->GetData(), data));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+  }
+  BufferPoolStats stats = bpm->GetStats();
+  EXPECT_EQ(2 * num_pages, stats.misses_);
+  EXPECT_EQ(2 * num_pages, stats.compressed_cache_hits_);
+  EXPECT_EQ(0, stats.compressed_cache_misses_);
+  EXPECT_EQ(num_pages - buffer_pool_size, stats.compressed_cache_pages_);
+  EXPECT_NE(std::string::npos, stats.ToString().find("compressed cache: 12 hits"));
+
+  // Scenario: A deleted page leaves the cache, so it is read from disk again.
+  EXPECT_EQ(true, bpm->DeletePage(page_ids[0]));
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids[0]));
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[0], false));
+  EXPECT_EQ(1, bpm->GetStats().compressed_cache_misses_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DISABLED_ResidentFetchScalingBenchmark) {
+  // Threads repeatedly fetch and unpin pages that are all resident, which is the hit path the page table serves
+  // without the instance latch.
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 256;
+  const size_t ops_per_thread = 1000000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  std::vector<page_id_t> page_ids(buffer_pool_size);
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, false);
+  }
+
+  for (size_t num_threads = 1; num_threads <= 64; num_threads *= 2) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([&, tid] {
+        std::mt19937 rng(static_cast<uint32_t>(tid));
+        for (size_t i = 0; i < ops_per_thread; ++i) {
+          page_id_t page_id = page_ids[rng() % buffer_pool_size];
+          EXPECT_NE(nullptr, bpm->FetchPage(page_id));
+          bpm->UnpinPage(page_id, false);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("%2zu threads: %8.2f Mops/s\n", num_threads,
+           static_cast<double>(num_threads * ops_per_thread) / elapsed.count() / 1e6);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DISABLED_SequentialScanPageSizeBenchmark) {
+  // A scan of a fixed amount of data through a fixed amount of memory, on a simulated NVMe SSD. Build with
+  // -DBUSTUB_PAGE_SIZE=8192 or 16384 and run again to compare page sizes: larger pages take fewer I/Os, though
+  // each one transfers more bytes and so takes longer.
+  const size_t data_size = 64 << 20;
+  const size_t pool_size = 4 << 20;
+  const auto num_pages = static_cast<page_id_t>(data_size / PAGE_SIZE);
+
+  auto *disk_manager = new DiskManagerMemory(DiskLatencyModel::Nvme());
+  char data[PAGE_SIZE] = {0};
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    snprintf(data, PAGE_SIZE, "page %d", page_id);
+    disk_manager->WritePage(page_id, data);
+  }
+  auto *bpm = new BufferPoolManagerInstance(pool_size / PAGE_SIZE, disk_manager);
+
+  auto start = std::chrono::steady_clock::now();
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(data, PAGE_SIZE, "page %d", page_id);
+    EXPECT_STREQ(data, page->GetData());
+    bpm->UnpinPage(page_id, false);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  printf("%2d KB pages: %6d reads, %8.2f MB/s\n", PAGE_SIZE / 1024, num_pages,
+         static_cast<double>(data_size) / elapsed.count() / (1 << 20));
+
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
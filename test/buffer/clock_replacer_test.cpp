@@ -10,7 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <cstdio>
+#include <random>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -19,7 +21,7 @@
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
   // Scenario: unpin six elements, i.e. add them to the replacer.
@@ -59,4 +61,78 @@ TEST(ClockReplacerTest, DISABLED_SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+TEST(ClockReplacerTest, ConcurrencyTest) {
+  const size_t num_pages = 64;
+  const int num_threads = 4;
+  ClockReplacer clock_replacer(num_pages);
+
+  // Scenario: every thread owns a disjoint set of frames and cycles them through unpin, pin and victim.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&clock_replacer, tid] {
+      for (int round = 0; round < 1000; ++round) {
+        for (frame_id_t frame_id = tid; frame_id < static_cast<frame_id_t>(num_pages); frame_id += num_threads) {
+          clock_replacer.Unpin(frame_id);
+        }
+        for (frame_id_t frame_id = tid; frame_id < static_cast<frame_id_t>(num_pages); frame_id += 2 * num_threads) {
+          clock_replacer.Pin(frame_id);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: only the frames that were left unpinned can be victimized, each exactly once.
+  EXPECT_EQ(num_pages / 2, clock_replacer.Size());
+  std::vector<bool> victimized(num_pages, false);
+  int value;
+  while (clock_replacer.Victim(&value)) {
+    EXPECT_FALSE(victimized[value]);
+    EXPECT_EQ(1, (value / num_threads) % 2);
+    victimized[value] = true;
+  }
+  EXPECT_EQ(0, clock_replacer.Size());
+
+  // Scenario: threads race to unpin, pin and victimize the same frames, and the size never leaves its bounds.
+  std::atomic<bool> done{false};
+  std::atomic<bool> in_bounds{true};
+  std::thread observer([&] {
+    while (!done) {
+      if (clock_replacer.Size() > num_pages) {
+        in_bounds = false;
+      }
+    }
+  });
+  threads.clear();
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&clock_replacer, tid] {
+      std::mt19937 rng(tid);
+      int victim;
+      for (int round = 0; round < 100000; ++round) {
+        auto frame_id = static_cast<frame_id_t>(rng() % 2);
+        switch (rng() % 3) {
+          case 0:
+            clock_replacer.Unpin(frame_id);
+            break;
+          case 1:
+            clock_replacer.Pin(frame_id);
+            break;
+          default:
+            clock_replacer.Victim(&victim);
+            break;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  done = true;
+  observer.join();
+  EXPECT_EQ(true, in_bounds);
+  EXPECT_EQ(clock_replacer.EvictionOrder().size(), clock_replacer.Size());
+}
+
 }  // namespace bustub
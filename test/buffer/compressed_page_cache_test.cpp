@@ -0,0 +1,143 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache_test.cpp
+//
+// Identification: test/buffer/compressed_page_cache_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "common/util/lz_util.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** Fill a page like a table page: a few records at the end and zeroed free space in between. */
+void FillPage(char *data, int seed) {
+  memset(data, 0, PAGE_SIZE);
+  for (int i = 0; i < 16; ++i) {
+    snprintf(data + PAGE_SIZE - 64 * (i + 1), 64, "record %d of page %d, padded to some length", i, seed);
+  }
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, CodecTest) {
+  std::mt19937 rng(15445);
+  char page[PAGE_SIZE];
+  char compressed[2 * PAGE_SIZE];
+  char restored[PAGE_SIZE];
+
+  // Scenario: Mostly empty pages shrink a lot, and come back unchanged.
+  FillPage(page, 1);
+  size_t size = LZUtil::Compress(page, PAGE_SIZE, compressed, sizeof(compressed));
+  ASSERT_NE(0, size);
+  EXPECT_GT(static_cast<size_t>(PAGE_SIZE / 4), size);
+  ASSERT_EQ(true, LZUtil::Decompress(compressed, size, restored, PAGE_SIZE));
+  EXPECT_EQ(0, memcmp(page, restored, PAGE_SIZE));
+
+  // Scenario: Random data does not compress, but still round-trips given enough room.
+  for (auto &byte : page) {
+    byte = static_cast<char>(rng());
+  }
+  EXPECT_EQ(0, LZUtil::Compress(page, PAGE_SIZE, compressed, CompressedPageCache::MAX_COMPRESSED_SIZE));
+  size = LZUtil::Compress(page, PAGE_SIZE, compressed, sizeof(compressed));
+  ASSERT_NE(0, size);
+  ASSERT_EQ(true, LZUtil::Decompress(compressed, size, restored, PAGE_SIZE));
+  EXPECT_EQ(0, memcmp(page, restored, PAGE_SIZE));
+
+  // Scenario: Data with short repeats and long runs of every length round-trips.
+  for (int round = 0; round < 100; ++round) {
+    size_t length = rng() % PAGE_SIZE + 1;
+    for (size_t i = 0; i < length;) {
+      char byte = static_cast<char>(rng() % 4);
+      size_t run = rng() % 3 == 0 ? rng() % 600 : 1;
+      for (size_t j = 0; j < run && i < length; ++j, ++i) {
+        page[i] = byte;
+      }
+    }
+    size = LZUtil::Compress(page, length, compressed, sizeof(compressed));
+    ASSERT_NE(0, size);
+    ASSERT_EQ(true, LZUtil::Decompress(compressed, size, restored, length));
+    EXPECT_EQ(0, memcmp(page, restored, length));
+  }
+
+  // Scenario: Truncated or corrupt data is rejected.
+  FillPage(page, 2);
+  size = LZUtil::Compress(page, PAGE_SIZE, compressed, sizeof(compressed));
+  EXPECT_EQ(false, LZUtil::Decompress(compressed, size - 1, restored, PAGE_SIZE));
+  EXPECT_EQ(false, LZUtil::Decompress(compressed, size, restored, PAGE_SIZE - 1));
+  for (int round = 0; round < 100; ++round) {
+    std::string corrupt(compressed, size);
+    corrupt[rng() % size] = static_cast<char>(rng());
+    // Must not crash; the result depends on the byte hit.
+    LZUtil::Decompress(corrupt.data(), corrupt.size(), restored, PAGE_SIZE);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, SampleTest) {
+  char page[PAGE_SIZE];
+  char restored[PAGE_SIZE];
+  FillPage(page, 0);
+  size_t page_size = LZUtil::Compress(page, PAGE_SIZE, restored, sizeof(restored));
+  CompressedPageCache cache(3 * page_size);
+
+  // Scenario: A cached page is read back once, then it is gone.
+  cache.Insert(0, page);
+  EXPECT_EQ(page_size, cache.GetSize());
+  EXPECT_EQ(true, cache.Lookup(0, restored));
+  EXPECT_EQ(0, memcmp(page, restored, PAGE_SIZE));
+  EXPECT_EQ(false, cache.Lookup(0, restored));
+  EXPECT_EQ(0, cache.GetSize());
+
+  // Scenario: The oldest pages make room for new ones within the budget.
+  for (int page_id = 0; page_id < 5; ++page_id) {
+    FillPage(page, page_id);
+    cache.Insert(page_id, page);
+  }
+  EXPECT_EQ(3 * page_size, cache.GetSize());
+  EXPECT_EQ(false, cache.Lookup(0, restored));
+  EXPECT_EQ(false, cache.Lookup(1, restored));
+  for (int page_id = 2; page_id < 5; ++page_id) {
+    FillPage(page, page_id);
+    ASSERT_EQ(true, cache.Lookup(page_id, restored));
+    EXPECT_EQ(0, memcmp(page, restored, PAGE_SIZE));
+  }
+
+  // Scenario: Incompressible pages are not cached, and erased pages are gone.
+  std::mt19937 rng(15445);
+  for (auto &byte : page) {
+    byte = static_cast<char>(rng());
+  }
+  cache.Insert(7, page);
+  EXPECT_EQ(false, cache.Lookup(7, restored));
+  FillPage(page, 8);
+  cache.Insert(8, page);
+  cache.Erase(8);
+  EXPECT_EQ(false, cache.Lookup(8, restored));
+
+  BufferPoolStats stats;
+  cache.Collect(&stats);
+  EXPECT_EQ(4, stats.compressed_cache_hits_);
+  EXPECT_EQ(7, stats.compressed_cache_insertions_);
+  EXPECT_EQ(1, stats.compressed_cache_rejections_);
+  EXPECT_EQ(2, stats.compressed_cache_evictions_);
+  EXPECT_EQ(0, stats.compressed_cache_pages_);
+  EXPECT_EQ(0, stats.compressed_cache_bytes_);
+}
+
+}  // namespace bustub
@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: access frames 1-6 once, and frame 1 a second time.
+  for (frame_id_t frame_id = 1; frame_id <= 6; ++frame_id) {
+    lru_k_replacer.Pin(frame_id);
+  }
+  lru_k_replacer.Pin(1);
+  for (frame_id_t frame_id = 1; frame_id <= 6; ++frame_id) {
+    lru_k_replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames with a single access have an infinite backward K-distance and go first, oldest first.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+
+  // Scenario: pin 5 again. It now has two accesses, but its 2nd most recent one is newer than frame 1's.
+  lru_k_replacer.Pin(5);
+  EXPECT_EQ(2, lru_k_replacer.Size());
+  lru_k_replacer.Unpin(5);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+
+  // Scenario: a victimized frame starts over with an empty history.
+  lru_k_replacer.Pin(5);
+  lru_k_replacer.Unpin(5);
+  lru_k_replacer.Pin(6);
+  lru_k_replacer.Pin(6);
+  lru_k_replacer.Unpin(6);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+}
+
+/**
+ * Simulate a buffer pool of pool_size frames driven by the given replacer. Every round performs one point lookup on
+ * a small hot set followed by one page of a full sequential scan over a large table.
+ * @return the hit ratio of the point lookups
+ */
+auto PointLookupHitRatio(Replacer *replacer, size_t pool_size) -> double {
+  const page_id_t num_hot_pages = static_cast<page_id_t>(pool_size / 2);
+  const page_id_t num_scan_pages = static_cast<page_id_t>(pool_size * 20);
+  const int num_rounds = 200000;
+
+  std::unordered_map<page_id_t, frame_id_t> page_table;
+  std::vector<page_id_t> frame_page(pool_size, INVALID_PAGE_ID);
+  frame_id_t next_free = 0;
+  auto access = [&](page_id_t page_id) -> bool {
+    auto it = page_table.find(page_id);
+    bool hit = it != page_table.end();
+    frame_id_t frame_id;
+    if (hit) {
+      frame_id = it->second;
+    } else if (next_free < static_cast<frame_id_t>(pool_size)) {
+      frame_id = next_free++;
+    } else {
+      EXPECT_TRUE(replacer->Victim(&frame_id));
+      page_table.erase(frame_page[frame_id]);
+    }
+    page_table[page_id] = frame_id;
+    frame_page[frame_id] = page_id;
+    replacer->Pin(frame_id);
+    replacer->Unpin(frame_id);
+    return hit;
+  };
+
+  std::mt19937 rng(15445);
+  std::uniform_int_distribution<page_id_t> hot_dist(0, num_hot_pages - 1);
+  int hits = 0;
+  for (int round = 0; round < num_rounds; ++round) {
+    hits += access(hot_dist(rng)) ? 1 : 0;
+    access(num_hot_pages + round % num_scan_pages);
+  }
+  return static_cast<double>(hits) / num_rounds;
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  const size_t pool_size = 1000;
+  auto lru_replacer = std::make_unique<LRUReplacer>(pool_size);
+  auto lru_k_replacer = std::make_unique<LRUKReplacer>(pool_size, 2);
+
+  double lru_hit_ratio = PointLookupHitRatio(lru_replacer.get(), pool_size);
+  double lru_k_hit_ratio = PointLookupHitRatio(lru_k_replacer.get(), pool_size);
+  printf("point lookup hit ratio under a concurrent scan: LRU %.3f, LRU-2 %.3f\n", lru_hit_ratio, lru_k_hit_ratio);
+
+  // Scenario: the scan flushes the hot set out of a pure recency pool, but not out of LRU-K.
+  EXPECT_GT(lru_k_hit_ratio, 0.95);
+  EXPECT_GT(lru_k_hit_ratio, lru_hit_ratio);
+}
+
+}  // namespace bustub
@@ -10,7 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <random>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -59,4 +61,36 @@ TEST(LRUReplacerTest, SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+// Run with --gtest_also_run_disabled_tests to print Pin/Unpin/Victim throughput for growing pool sizes.
+TEST(LRUReplacerTest, DISABLED_PerformanceTest) {
+  const size_t num_ops = 4000000;
+  std::mt19937 rng(15445);
+  for (size_t num_pages = 1000; num_pages <= 1000000; num_pages *= 10) {
+    LRUReplacer lru_replacer(num_pages);
+    for (size_t i = 0; i < num_pages; ++i) {
+      lru_replacer.Unpin(static_cast<frame_id_t>(i));
+    }
+    std::uniform_int_distribution<frame_id_t> frame_dist(0, static_cast<frame_id_t>(num_pages - 1));
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_ops; ++i) {
+      frame_id_t frame_id = frame_dist(rng);
+      switch (i % 3) {
+        case 0:
+          lru_replacer.Pin(frame_id);
+          break;
+        case 1:
+          lru_replacer.Unpin(frame_id);
+          break;
+        default:
+          if (lru_replacer.Victim(&frame_id)) {
+            lru_replacer.Unpin(frame_id);
+          }
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("pool size %8zu: %.2f Mops/s\n", num_pages, num_ops / elapsed.count() / 1e6);
+  }
+}
+
 }  // namespace bustub
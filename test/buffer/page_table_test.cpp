@@ -0,0 +1,133 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/page_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(8);
+  frame_id_t frame_id;
+
+  // Scenario: an empty table finds nothing.
+  EXPECT_EQ(false, page_table.Find(0, &frame_id));
+  EXPECT_EQ(0, page_table.Size());
+
+  // Scenario: insert pages and find them again.
+  for (page_id_t page_id = 0; page_id < 8; ++page_id) {
+    page_table.Insert(page_id * 3, page_id);
+  }
+  EXPECT_EQ(8, page_table.Size());
+  for (page_id_t page_id = 0; page_id < 8; ++page_id) {
+    EXPECT_EQ(true, page_table.Find(page_id * 3, &frame_id));
+    EXPECT_EQ(page_id, frame_id);
+  }
+  EXPECT_EQ(false, page_table.Find(1, &frame_id));
+
+  // Scenario: inserting a mapped page replaces its frame.
+  page_table.Insert(3, 7);
+  EXPECT_EQ(8, page_table.Size());
+  EXPECT_EQ(true, page_table.Find(3, &frame_id));
+  EXPECT_EQ(7, frame_id);
+
+  // Scenario: erase pages.
+  EXPECT_EQ(true, page_table.Erase(3));
+  EXPECT_EQ(false, page_table.Erase(3));
+  EXPECT_EQ(false, page_table.Find(3, &frame_id));
+  EXPECT_EQ(7, page_table.Size());
+
+  // Scenario: ForEach visits every mapping once.
+  std::unordered_map<page_id_t, frame_id_t> mappings;
+  page_table.ForEach([&](page_id_t page_id, frame_id_t frame_id) { mappings[page_id] = frame_id; });
+  EXPECT_EQ(7, mappings.size());
+  EXPECT_EQ(4, mappings[12]);
+}
+
+TEST(PageTableTest, EraseKeepsProbeRunsTest) {
+  // Scenario: fill the table to capacity with strided page ids, as an instance of a parallel pool sees them, and
+  // check that every remaining page is still found after each erase has shifted entries back.
+  const size_t num_frames = 64;
+  PageTable page_table(num_frames);
+  std::unordered_map<page_id_t, frame_id_t> expected;
+  for (size_t i = 0; i < num_frames; ++i) {
+    auto page_id = static_cast<page_id_t>(i * 16);
+    page_table.Insert(page_id, static_cast<frame_id_t>(i));
+    expected[page_id] = static_cast<frame_id_t>(i);
+  }
+
+  for (size_t i = 0; i < num_frames; i += 3) {
+    auto page_id = static_cast<page_id_t>(i * 16);
+    EXPECT_EQ(true, page_table.Erase(page_id));
+    expected.erase(page_id);
+
+    for (const auto &[expected_page_id, expected_frame_id] : expected) {
+      frame_id_t frame_id;
+      ASSERT_EQ(true, page_table.Find(expected_page_id, &frame_id));
+      EXPECT_EQ(expected_frame_id, frame_id);
+    }
+  }
+  EXPECT_EQ(expected.size(), page_table.Size());
+}
+
+TEST(PageTableTest, ConcurrentFindTest) {
+  // Scenario: readers keep finding pages that are never erased while a writer churns other pages.
+  const size_t num_frames = 128;
+  const page_id_t num_stable = 32;
+  PageTable page_table(num_frames);
+  for (page_id_t page_id = 0; page_id < num_stable; ++page_id) {
+    page_table.Insert(page_id, page_id);
+  }
+
+  std::atomic<bool> done{false};
+  std::thread writer([&] {
+    for (int round = 0; round < 2000; ++round) {
+      for (page_id_t page_id = num_stable; page_id < static_cast<page_id_t>(num_frames); ++page_id) {
+        page_table.Insert(page_id + round, page_id);
+      }
+      for (page_id_t page_id = num_stable; page_id < static_cast<page_id_t>(num_frames); ++page_id) {
+        page_table.Erase(page_id + round);
+      }
+    }
+    done = true;
+  });
+
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < 4; ++tid) {
+    readers.emplace_back([&] {
+      while (!done) {
+        for (page_id_t page_id = 0; page_id < num_stable; ++page_id) {
+          // A lookup racing with a backward shift may miss; it must never return a wrong frame.
+          frame_id_t frame_id;
+          if (page_table.Find(page_id, &frame_id)) {
+            EXPECT_EQ(page_id, frame_id);
+          }
+        }
+      }
+    });
+  }
+  writer.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  for (page_id_t page_id = 0; page_id < num_stable; ++page_id) {
+    frame_id_t frame_id;
+    EXPECT_EQ(true, page_table.Find(page_id, &frame_id));
+  }
+}
+
+}  // namespace bustub
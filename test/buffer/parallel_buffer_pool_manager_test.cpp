@@ -11,10 +11,16 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/parallel_buffer_pool_manager.h"
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <cstring>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
+#include "common/util/numa_util.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
@@ -151,4 +157,228 @@ TEST(ParallelBufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FetchPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < 9; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: A batch spread over every instance comes back in request order.
+  const page_id_t page_ids[] = {8, 0, 4, 2, 7, 3};
+  Page *pages[6];
+  EXPECT_EQ(true, bpm->FetchPages(page_ids, 6, pages));
+  char data[PAGE_SIZE];
+  for (size_t i = 0; i < 6; ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+    snprintf(data, sizeof(data), "page %d", page_ids[i]);
+    EXPECT_EQ(0, strcmp(pages[i]->GetData(), data));
+  }
+  EXPECT_EQ(true, bpm->UnpinPages(page_ids, 6, false));
+  EXPECT_EQ(false, bpm->UnpinPages(page_ids, 1, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FlushAllPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 20;
+  const size_t num_instances = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  std::vector<page_id_t> page_ids(num_instances * buffer_pool_size);
+  for (auto &page_id : page_ids) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+  }
+  // Scenario: Every dirty page reaches the disk, pinned or not, and is clean afterwards.
+  for (size_t i = 0; i < page_ids.size(); i += 2) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], true));
+  }
+  for (size_t i = 1; i < page_ids.size(); i += 2) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], true));
+  }
+  bpm->FlushAllPages();
+  char data[PAGE_SIZE];
+  char expected[PAGE_SIZE];
+  for (auto page_id : page_ids) {
+    disk_manager->ReadPage(page_id, data);
+    snprintf(expected, sizeof(expected), "page %d", page_id);
+    EXPECT_EQ(0, strcmp(expected, data));
+    Page *page = bpm->FetchPage(page_id);
+    EXPECT_EQ(false, page->IsDirty());
+    bpm->UnpinPage(page_id, false);
+  }
+  for (size_t i = 1; i < page_ids.size(); i += 2) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+  }
+
+  // Scenario: Pages keep being fetched and modified while they are flushed.
+  std::atomic<bool> done{false};
+  std::thread writer([&] {
+    std::mt19937 rng(15445);
+    while (!done) {
+      page_id_t page_id = page_ids[rng() % page_ids.size()];
+      Page *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      page->WLatch();
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+      page->WUnlatch();
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    }
+  });
+  for (int round = 0; round < 20; ++round) {
+    bpm->FlushAllPages();
+  }
+  done = true;
+  writer.join();
+  bpm->FlushAllPages();
+  for (auto page_id : page_ids) {
+    disk_manager->ReadPage(page_id, data);
+    snprintf(expected, sizeof(expected), "page %d", page_id);
+    EXPECT_EQ(0, strcmp(expected, data));
+  }
+  EXPECT_LE(page_ids.size(), bpm->GetStats().write_backs_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+  const size_t num_instances = 3;
+  const size_t max_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, nullptr,
+                                            ReplacerPolicy::LRU, max_pool_size);
+  EXPECT_EQ(6, bpm->GetPoolSize());
+
+  // Scenario: The frames are spread over the instances, each of which needs at least one and at most its maximum.
+  EXPECT_EQ(false, bpm->Resize(2));
+  EXPECT_EQ(false, bpm->Resize(13));
+  EXPECT_EQ(6, bpm->GetPoolSize());
+  EXPECT_EQ(true, bpm->Resize(11));
+  EXPECT_EQ(11, bpm->GetPoolSize());
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < 11; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    bpm->UnpinPage(page_id_temp, true);
+  }
+
+  // Scenario: Shrinking writes the pages back, so they can still be fetched.
+  EXPECT_EQ(true, bpm->Resize(3));
+  EXPECT_EQ(3, bpm->GetPoolSize());
+  for (page_id_t page_id = 0; page_id < 11; ++page_id) {
+    EXPECT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, StatsTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+  const size_t num_instances = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  // Scenario: The snapshot sums the statistics of every instance.
+  std::vector<page_id_t> page_ids(num_instances * buffer_pool_size);
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  for (auto page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  BufferPoolStats stats = bpm->GetStats();
+  EXPECT_EQ(page_ids.size(), stats.hits_);
+  EXPECT_EQ(0, stats.misses_);
+  EXPECT_EQ(num_instances, stats.pinned_high_water_);
+  EXPECT_EQ(0, stats.free_frames_);
+  EXPECT_NE(std::string::npos, stats.ToString().find("hits: 6, misses: 0"));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, DISABLED_NewPageScalingBenchmark) {
+  // Threads keep allocating pages, as an insert-heavy workload does. Build with BUSTUB_ENABLE_NUMA to place every
+  // instance on its own node and let threads allocate on their local nodes.
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 1024;
+  const size_t num_instances = 16;
+  const size_t ops_per_thread = 20000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  printf("%u NUMA nodes\n", NumaUtil::NodeCount());
+
+  for (size_t num_threads = 1; num_threads <= 64; num_threads *= 2) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([&] {
+        page_id_t page_id;
+        for (size_t i = 0; i < ops_per_thread; ++i) {
+          EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+          bpm->UnpinPage(page_id, false);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("%2zu threads: %8.2f Mops/s\n", num_threads,
+           static_cast<double>(num_threads * ops_per_thread) / elapsed.count() / 1e6);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
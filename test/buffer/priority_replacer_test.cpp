@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// priority_replacer_test.cpp
+//
+// Identification: test/buffer/priority_replacer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/priority_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PriorityReplacerTest, SampleTest) {
+  PriorityReplacer replacer(new LRUReplacer(7), 7, 2);
+
+  // Scenario: unpin three high priority frames and three normal ones. The protected segment holds two frames, so the
+  // least recently used high priority frame is demoted.
+  replacer.SetPriority(1, PagePriority::HIGH);
+  replacer.SetPriority(2, PagePriority::HIGH);
+  replacer.SetPriority(3, PagePriority::HIGH);
+  for (frame_id_t frame_id = 1; frame_id <= 6; ++frame_id) {
+    replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(6, replacer.Size());
+  EXPECT_EQ((std::vector<frame_id_t>{1, 4, 5, 6, 2, 3}), replacer.EvictionOrder());
+
+  // Scenario: pinning and unpinning a protected frame moves it to the end of the protected segment.
+  replacer.Pin(2);
+  EXPECT_EQ(5, replacer.Size());
+  replacer.Unpin(2);
+
+  // Scenario: the normal frames go first, then the protected ones.
+  int value;
+  for (frame_id_t expected : {1, 4, 5, 6, 3, 2}) {
+    ASSERT_EQ(true, replacer.Victim(&value));
+    EXPECT_EQ(expected, value);
+  }
+  EXPECT_EQ(false, replacer.Victim(&value));
+  EXPECT_EQ(0, replacer.Size());
+
+  // Scenario: a victimized frame has lost its priority, so it competes with the normal frames again.
+  replacer.Unpin(2);
+  replacer.Unpin(5);
+  replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+
+  // Scenario: removing a protected frame drops it and its priority.
+  replacer.SetPriority(4, PagePriority::HIGH);
+  replacer.Unpin(4);
+  replacer.Remove(4);
+  EXPECT_EQ(1, replacer.Size());
+  replacer.Unpin(4);
+  replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+}
+
+TEST(PriorityReplacerTest, HistoryTest) {
+  PriorityReplacer replacer(new LRUKReplacer(5, 2), 5, 1);
+
+  // Scenario: a high priority frame is accessed twice, the second time while it is protected, and two normal frames
+  // once each.
+  replacer.SetPriority(1, PagePriority::HIGH);
+  for (frame_id_t frame_id : {1, 1, 2, 3}) {
+    replacer.Pin(frame_id);
+    replacer.Unpin(frame_id);
+  }
+
+  // Scenario: another high priority frame demotes the first one. The wrapped replacer saw both of its accesses, so it
+  // outlives the frames accessed once.
+  replacer.SetPriority(4, PagePriority::HIGH);
+  replacer.Pin(4);
+  replacer.Unpin(4);
+  int value;
+  for (frame_id_t expected : {2, 3, 1, 4}) {
+    ASSERT_EQ(true, replacer.Victim(&value));
+    EXPECT_EQ(expected, value);
+  }
+  EXPECT_EQ(false, replacer.Victim(&value));
+}
+
+}  // namespace bustub
@@ -0,0 +1,163 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_memory_test.cpp
+//
+// Identification: test/storage/disk_manager_memory_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_memory.h"
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(DiskManagerMemoryTest, ReadWritePageTest) {
+  DiskManagerMemory dm;
+  char data[PAGE_SIZE] = {0};
+  char buf[PAGE_SIZE];
+
+  // Scenario: Pages read back what was written, and pages never written read as zeros.
+  snprintf(data, sizeof(data), "A test string.");
+  dm.WritePage(0, data);
+  dm.WritePage(1000, data);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(0, std::memcmp(buf, data, PAGE_SIZE));
+  dm.ReadPage(1000, buf);
+  EXPECT_EQ(0, std::memcmp(buf, data, PAGE_SIZE));
+  dm.ReadPage(500, buf);
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(1001 * PAGE_SIZE, dm.GetDbFileSize());
+  EXPECT_EQ(2, dm.GetNumWrites());
+
+  // Scenario: Runs of pages and asynchronous requests go through the same pages.
+  char other[PAGE_SIZE] = {0};
+  snprintf(other, sizeof(other), "Another string.");
+  const char *run[] = {other, data};
+  dm.WritePages(2000, run, 2);
+  char buf2[PAGE_SIZE];
+  char *bufs[] = {buf, buf2};
+  dm.ReadPages(2000, bufs, 2);
+  EXPECT_EQ(0, std::memcmp(buf, other, PAGE_SIZE));
+  EXPECT_EQ(0, std::memcmp(buf2, data, PAGE_SIZE));
+  EXPECT_EQ(true, dm.WritePageAsync(3000, other).get());
+  EXPECT_EQ(true, dm.ReadPageAsync(3000, buf).get());
+  EXPECT_EQ(0, std::memcmp(buf, other, PAGE_SIZE));
+  EXPECT_EQ(false, dm.ReadPageAsync(5000, buf).get());
+
+  // Scenario: The log is kept in memory as well.
+  char log[16] = "log record";
+  dm.WriteLog(log, sizeof(log));
+  char log_buf[32];
+  EXPECT_EQ(true, dm.ReadLog(log_buf, sizeof(log_buf), 0));
+  EXPECT_EQ(0, std::memcmp(log_buf, log, sizeof(log)));
+  EXPECT_EQ(false, dm.ReadLog(log_buf, sizeof(log_buf), sizeof(log)));
+  EXPECT_EQ(1, dm.GetNumFlushes());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerMemoryTest, LatencyTest) {
+  using std::chrono::milliseconds;
+  const int num_threads = 4;
+  DiskLatencyModel model;
+  model.read_ = {LatencyDistribution::Kind::FIXED, milliseconds(5), milliseconds(0)};
+  model.sync_ = {LatencyDistribution::Kind::UNIFORM, milliseconds(5), milliseconds(5)};
+  model.concurrency_ = 1;
+  DiskManagerMemory dm(model);
+  char data[PAGE_SIZE] = {0};
+  dm.WritePage(0, data);
+
+  // Scenario: A device serving one read at a time makes concurrent reads take turns.
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&dm] {
+      char buf[PAGE_SIZE];
+      dm.ReadPage(0, buf);
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_LE(milliseconds(5 * num_threads), std::chrono::steady_clock::now() - start);
+
+  // Scenario: A sync costs its latency only after writes, and writes cost nothing here.
+  start = std::chrono::steady_clock::now();
+  dm.Sync();
+  EXPECT_LE(milliseconds(5), std::chrono::steady_clock::now() - start);
+  start = std::chrono::steady_clock::now();
+  dm.Sync();
+  EXPECT_GT(milliseconds(5), std::chrono::steady_clock::now() - start);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerMemoryTest, BandwidthTest) {
+  using std::chrono::milliseconds;
+  const size_t num_pages = 8;
+  DiskLatencyModel model;
+  model.bandwidth_ = PAGE_SIZE * 1000;
+  DiskManagerMemory dm(model);
+  std::vector<char> data(num_pages * PAGE_SIZE);
+  const char *pages[num_pages];
+  for (size_t i = 0; i < num_pages; ++i) {
+    pages[i] = data.data() + i * PAGE_SIZE;
+  }
+
+  // Scenario: At a page per millisecond, a run of pages takes as much longer as it is larger.
+  auto start = std::chrono::steady_clock::now();
+  dm.WritePage(0, pages[0]);
+  EXPECT_LE(milliseconds(1), std::chrono::steady_clock::now() - start);
+  start = std::chrono::steady_clock::now();
+  dm.WritePages(0, pages, num_pages);
+  EXPECT_LE(milliseconds(num_pages), std::chrono::steady_clock::now() - start);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerMemoryTest, BufferPoolTest) {
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 100;
+  auto *disk_manager = new DiskManagerMemory(DiskLatencyModel::Nvme());
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: A buffer pool much smaller than its data pages in and out of the memory-backed disk.
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page_id);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  char expected[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_STREQ(expected, page->GetData());
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -10,7 +10,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <future>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
@@ -55,6 +61,173 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWritePageTest) {
+  const int num_threads = 8;
+  const int pages_per_thread = 64;
+  std::string db_file("test.db");
+
+  // Scenario: Threads write and read back interleaved pages at the same time, with buffered and direct I/O.
+  for (bool direct_io : {false, true}) {
+    enable_direct_io = direct_io;
+    auto dm = DiskManager(db_file);
+    enable_direct_io = false;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&dm, t] {
+        char data[PAGE_SIZE];
+        char buf[PAGE_SIZE];
+        for (int i = 0; i < pages_per_thread; ++i) {
+          page_id_t page_id = i * num_threads + t;
+          std::memset(data, 0, sizeof(data));
+          snprintf(data, sizeof(data), "page %d", page_id);
+          dm.WritePage(page_id, data);
+          dm.ReadPage(page_id, buf);
+          EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(num_threads * pages_per_thread, dm.GetNumWrites());
+    dm.ShutDown();
+  }
+
+  // Scenario: The pages are there after reopening the file, and reads past its end leave the buffer alone.
+  auto dm = DiskManager(db_file);
+  char buf[PAGE_SIZE];
+  char expected[PAGE_SIZE] = {0};
+  for (page_id_t page_id = 0; page_id < num_threads * pages_per_thread; ++page_id) {
+    snprintf(expected, sizeof(expected), "page %d", page_id);
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ(0, std::memcmp(buf, expected, sizeof(buf)));
+  }
+  dm.ReadPage(num_threads * pages_per_thread + 1, buf);
+  EXPECT_EQ(0, std::memcmp(buf, expected, sizeof(buf)));
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ReadWritePagesTest) {
+  // More pages than a single vectored system call takes.
+  const size_t num_pages = 1100;
+  std::string db_file("test.db");
+  auto *aligned = static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, num_pages * PAGE_SIZE));
+  std::vector<char> unaligned(num_pages * PAGE_SIZE + 1);
+  // Every other page lives in a buffer that direct I/O cannot use as is.
+  auto buffer = [&](size_t i) { return i % 2 == 0 ? aligned + i * PAGE_SIZE : unaligned.data() + 1 + i * PAGE_SIZE; };
+  std::vector<char *> pages(num_pages);
+  for (size_t i = 0; i < num_pages; ++i) {
+    pages[i] = buffer(i);
+  }
+
+  // Scenario: Scattered buffers are written as consecutive pages and read back, with buffered and direct I/O.
+  for (bool direct_io : {false, true}) {
+    remove(db_file.c_str());
+    enable_direct_io = direct_io;
+    auto dm = DiskManager(db_file);
+    enable_direct_io = false;
+    for (size_t i = 0; i < num_pages; ++i) {
+      std::memset(pages[i], 0, PAGE_SIZE);
+      snprintf(pages[i], PAGE_SIZE, "page %zu", i);
+    }
+    dm.WritePages(0, pages.data(), num_pages);
+    EXPECT_EQ(num_pages, dm.GetNumWrites());
+    char buf[PAGE_SIZE];
+    dm.ReadPage(num_pages - 1, buf);
+    EXPECT_EQ(0, std::memcmp(buf, pages[num_pages - 1], PAGE_SIZE));
+
+    for (size_t i = 0; i < num_pages; ++i) {
+      std::memset(pages[i], 1, PAGE_SIZE);
+    }
+    dm.ReadPages(0, pages.data(), num_pages);
+    char expected[PAGE_SIZE];
+    for (size_t i = 0; i < num_pages; ++i) {
+      std::memset(expected, 0, PAGE_SIZE);
+      snprintf(expected, PAGE_SIZE, "page %zu", i);
+      EXPECT_EQ(0, std::memcmp(expected, pages[i], PAGE_SIZE));
+    }
+
+    // Scenario: The pages of a read beyond the end of the file are zeroed.
+    for (size_t i = 0; i < 4; ++i) {
+      std::memset(pages[i], 1, PAGE_SIZE);
+    }
+    dm.ReadPages(num_pages - 2, pages.data(), 4);
+    std::memset(expected, 0, PAGE_SIZE);
+    snprintf(expected, PAGE_SIZE, "page %zu", num_pages - 1);
+    EXPECT_EQ(0, std::memcmp(pages[1], expected, PAGE_SIZE));
+    std::memset(expected, 0, PAGE_SIZE);
+    EXPECT_EQ(0, std::memcmp(pages[2], expected, PAGE_SIZE));
+    EXPECT_EQ(0, std::memcmp(pages[3], expected, PAGE_SIZE));
+
+    // Scenario: So are the pages of a read starting beyond the end of the file.
+    for (size_t i = 0; i < 4; ++i) {
+      std::memset(pages[i], 1, PAGE_SIZE);
+    }
+    dm.ReadPages(num_pages + 10, pages.data(), 4);
+    for (size_t i = 0; i < 4; ++i) {
+      EXPECT_EQ(0, std::memcmp(pages[i], expected, PAGE_SIZE));
+    }
+    dm.ShutDown();
+  }
+  free(aligned);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AsyncReadWritePageTest) {
+  const size_t num_pages = 300;
+  std::string db_file("test.db");
+  auto *buffers = static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, num_pages * PAGE_SIZE));
+
+  // Scenario: A batch larger than the queue depth is written and read back, through io_uring with registered
+  // buffers and through the thread pool.
+  for (bool io_uring : {true, false}) {
+    enable_io_uring = io_uring;
+    auto dm = DiskManager(db_file);
+    EXPECT_EQ(dm.RegisterBuffers(buffers, num_pages * PAGE_SIZE), dm.IsIoUring());
+    enable_io_uring = true;
+
+    std::atomic<size_t> written{0};
+    std::vector<DiskManager::DiskRequest> requests;
+    for (size_t i = 0; i < num_pages; ++i) {
+      char *data = buffers + i * PAGE_SIZE;
+      std::memset(data, 0, PAGE_SIZE);
+      snprintf(data, PAGE_SIZE, "page %zu", i);
+      requests.push_back({true, static_cast<page_id_t>(i), data, [&written](bool done) { written += done ? 1 : 0; }});
+    }
+    dm.SubmitRequests(requests.data(), requests.size());
+
+    // Reads and writes in flight together may overtake each other, so wait for the writes before reading back.
+    while (written < num_pages) {
+      std::this_thread::yield();
+    }
+    EXPECT_EQ(num_pages, dm.GetNumWrites());
+    std::memset(buffers, 0, num_pages * PAGE_SIZE);
+    std::vector<std::future<bool>> reads;
+    for (size_t i = 0; i < num_pages; ++i) {
+      reads.push_back(dm.ReadPageAsync(static_cast<page_id_t>(i), buffers + i * PAGE_SIZE));
+    }
+    char expected[PAGE_SIZE];
+    for (size_t i = 0; i < num_pages; ++i) {
+      EXPECT_EQ(true, reads[i].get());
+      snprintf(expected, sizeof(expected), "page %zu", i);
+      EXPECT_EQ(0, std::strcmp(buffers + i * PAGE_SIZE, expected));
+    }
+
+    // Scenario: Reads past the end of the file fail, and unregistered memory works too.
+    char buf[PAGE_SIZE];
+    EXPECT_EQ(false, dm.ReadPageAsync(num_pages + 1, buf).get());
+    dm.UnregisterBuffers(buffers);
+    EXPECT_EQ(true, dm.WritePageAsync(0, expected).get());
+    EXPECT_EQ(true, dm.ReadPageAsync(0, buf).get());
+    EXPECT_EQ(0, std::strcmp(buf, expected));
+    dm.ShutDown();
+    remove("test.db");
+  }
+  std::free(buffers);
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
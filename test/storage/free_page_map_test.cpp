@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_map_test.cpp
+//
+// Identification: test/storage/free_page_map_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/free_page_map.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+class FreePageMapTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override { remove("test.db"); }
+
+  // This function is called after every test.
+  void TearDown() override { remove("test.db"); };
+};
+
+// NOLINTNEXTLINE
+TEST_F(FreePageMapTest, SampleTest) {
+  DiskManager disk_manager("test.db");
+  bool reused;
+  {
+    FreePageMap map(&disk_manager, 1, 0);
+
+    // Scenario: A new file hands out the pages in order.
+    for (page_id_t page_id = 0; page_id < 10; ++page_id) {
+      EXPECT_EQ(page_id, map.Allocate(&reused));
+      EXPECT_EQ(false, reused);
+    }
+
+    // Scenario: Freed pages are reused next-fit before the file grows.
+    map.Free(7);
+    map.Free(3);
+    map.Free(5);
+    EXPECT_EQ(3, map.GetNumFreePages());
+    EXPECT_EQ(3, map.Allocate(&reused));
+    EXPECT_EQ(true, reused);
+    map.Free(2);
+    EXPECT_EQ(5, map.Allocate(&reused));
+    EXPECT_EQ(7, map.Allocate(&reused));
+    EXPECT_EQ(2, map.Allocate(&reused));
+    EXPECT_EQ(true, reused);
+    EXPECT_EQ(10, map.Allocate(&reused));
+    EXPECT_EQ(false, reused);
+
+    // Scenario: Pages never allocated, map pages and pages freed twice are ignored.
+    map.Free(100);
+    map.Free(FreePageMap::EXTENT_SIZE - 1);
+    map.Free(2);
+    map.Free(2);
+    EXPECT_EQ(1, map.GetNumFreePages());
+
+    map.Free(6);
+    map.Flush();
+  }
+
+  {
+    // Scenario: The free pages survive a restart, and pages allocated before it are not handed out again.
+    FreePageMap map(&disk_manager, 1, 0);
+    EXPECT_EQ(2, map.GetNumFreePages());
+    EXPECT_EQ(2, map.Allocate(&reused));
+    EXPECT_EQ(true, reused);
+    EXPECT_EQ(6, map.Allocate(&reused));
+    EXPECT_EQ(true, reused);
+    page_id_t page_id = map.Allocate(&reused);
+    EXPECT_EQ(false, reused);
+    EXPECT_LE(11, page_id);
+    EXPECT_GE(static_cast<page_id_t>(11 + FreePageMap::RESERVE_SIZE), page_id);
+
+    // Scenario: Allocating up to a map page skips it.
+    while (page_id < static_cast<page_id_t>(FreePageMap::EXTENT_SIZE - 2)) {
+      page_id = map.Allocate(&reused);
+    }
+    map.WriteAllocations();
+    EXPECT_EQ(FreePageMap::EXTENT_SIZE, map.Allocate(&reused));
+    EXPECT_EQ(true, FreePageMap::IsMapPage(FreePageMap::EXTENT_SIZE - 1, 1));
+    EXPECT_EQ(false, FreePageMap::IsMapPage(FreePageMap::EXTENT_SIZE, 1));
+  }
+
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(FreePageMapTest, InstanceTest) {
+  DiskManager disk_manager("test.db");
+  char data[PAGE_SIZE];
+  memset(data, 0, PAGE_SIZE);
+  bool reused;
+  {
+    // Scenario: Every instance hands out its own share of the page ids.
+    FreePageMap map0(&disk_manager, 2, 0);
+    FreePageMap map1(&disk_manager, 2, 1);
+    for (page_id_t i = 0; i < 5; ++i) {
+      EXPECT_EQ(2 * i, map0.Allocate(&reused));
+      EXPECT_EQ(2 * i + 1, map1.Allocate(&reused));
+    }
+    for (page_id_t page_id = 0; page_id < 10; ++page_id) {
+      disk_manager.WritePage(page_id, data);
+    }
+    map1.Free(3);
+    map1.Free(7);
+    map1.Flush();
+    EXPECT_EQ(true, FreePageMap::IsMapPage(2 * FreePageMap::EXTENT_SIZE - 1, 2));
+    EXPECT_EQ(true, FreePageMap::IsMapPage(2 * FreePageMap::EXTENT_SIZE - 2, 2));
+    EXPECT_EQ(false, FreePageMap::IsMapPage(2 * FreePageMap::EXTENT_SIZE - 3, 2));
+  }
+
+  {
+    // Scenario: After a restart, instance 0 keeps off the pages written, and instance 1 reuses its free pages.
+    FreePageMap map0(&disk_manager, 2, 0);
+    FreePageMap map1(&disk_manager, 2, 1);
+    EXPECT_EQ(0, map0.GetNumFreePages());
+    EXPECT_LE(10, map0.Allocate(&reused));
+    EXPECT_EQ(2, map1.GetNumFreePages());
+    EXPECT_EQ(3, map1.Allocate(&reused));
+    EXPECT_EQ(7, map1.Allocate(&reused));
+    EXPECT_LE(11, map1.Allocate(&reused));
+  }
+
+  disk_manager.ShutDown();
+}
+
+}  // namespace bustub
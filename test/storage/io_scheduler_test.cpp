@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_scheduler_test.cpp
+//
+// Identification: test/storage/io_scheduler_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/io_scheduler.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(IoSchedulerTest, WeightTest) {
+  IoScheduler scheduler(1);
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::mutex order_latch;
+  std::vector<IoClass> order;
+
+  // Scenario: One slot, held by a read, while write-backs and then more reads queue up.
+  std::thread blocker([&] { scheduler.Run(IoClass::DEMAND, 1, [&] { released.wait(); }); });
+  while (scheduler.GetStats(IoClass::DEMAND).in_flight_ == 0) {
+    std::this_thread::yield();
+  }
+  std::vector<std::thread> threads;
+  for (auto io_class : {IoClass::WRITE_BACK, IoClass::DEMAND}) {
+    for (int i = 0; i < 4; ++i) {
+      threads.emplace_back([&, io_class] {
+        scheduler.Run(io_class, 1, [&] {
+          std::scoped_lock latch(order_latch);
+          order.push_back(io_class);
+        });
+      });
+    }
+    while (scheduler.GetStats(io_class).queue_depth_ < 4) {
+      std::this_thread::yield();
+    }
+  }
+  release.set_value();
+  blocker.join();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: The reads, with the larger weight, do not wait for all the write-backs queued before them.
+  ASSERT_EQ(8, order.size());
+  auto last_read = std::find(order.rbegin(), order.rend(), IoClass::DEMAND).base() - order.begin();
+  auto write_backs_before = std::count(order.begin(), order.begin() + last_read, IoClass::WRITE_BACK);
+  EXPECT_GE(1, write_backs_before);
+
+  IoClassStats stats = scheduler.GetStats(IoClass::DEMAND);
+  EXPECT_EQ(5, stats.requests_);
+  EXPECT_EQ(5, stats.pages_);
+  EXPECT_EQ(0, stats.queue_depth_);
+  EXPECT_EQ(4, stats.max_queue_depth_);
+  EXPECT_EQ(0, stats.in_flight_);
+  EXPECT_EQ(4, scheduler.GetStats(IoClass::WRITE_BACK).requests_);
+  EXPECT_EQ(0, scheduler.GetStats(IoClass::WAL).requests_);
+  EXPECT_NE(std::string::npos, scheduler.ToString().find("write-back: 4 I/Os"));
+}
+
+// NOLINTNEXTLINE
+TEST(IoSchedulerTest, RateLimitTest) {
+  IoScheduler scheduler;
+  background_io_rate_limit = 1000;
+
+  // Scenario: Background I/O spends the saved up burst at once, then goes no faster than the limit.
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 3; ++i) {
+    scheduler.Run(IoClass::WRITE_BACK, BACKGROUND_IO_BURST, [] {});
+  }
+  // The last two wait for a full bucket each, at a page per millisecond.
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_LE(std::chrono::milliseconds(2 * BACKGROUND_IO_BURST - 10), elapsed);
+
+  // Scenario: Foreground I/O is not limited, even with the bucket empty.
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 3; ++i) {
+    scheduler.Run(IoClass::DEMAND, BACKGROUND_IO_BURST, [] {});
+  }
+  EXPECT_GT(std::chrono::milliseconds(50), std::chrono::steady_clock::now() - start);
+
+  background_io_rate_limit = 0;
+}
+
+}  // namespace bustub